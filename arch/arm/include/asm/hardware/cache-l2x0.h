@@ -61,6 +61,10 @@
 #define L2X0_CACHE_ID_PART_L210		(1 << 6)
 #define L2X0_CACHE_ID_PART_L310		(3 << 6)
 
+#define L2X0_EVENT_CNT_ENABLE		(1 << 0)
+#define L2X0_EVENT_CNT_RESET(x)		(1 << ((x) + 1))
+#define L2X0_EVENT_CNT_CFG_SRC_SHIFT	2
+
 #define L2X0_AUX_CTRL_MASK			0xc0000fff
 #define L2X0_AUX_CTRL_ASSOCIATIVITY_SHIFT	16
 #define L2X0_AUX_CTRL_WAY_SIZE_SHIFT		17
@@ -74,6 +78,11 @@
 
 #ifndef __ASSEMBLY__
 extern void __init l2x0_init(void __iomem *base, __u32 aux_val, __u32 aux_mask);
+#ifdef CONFIG_CACHE_L2X0_PMU
+extern void __init l2x0_pmu_register(void __iomem *base, __u32 cache_id);
+#else
+static inline void l2x0_pmu_register(void __iomem *base, __u32 cache_id) {}
+#endif
 #endif
 
 #endif
@@ -0,0 +1,27 @@
+/*
+ * linux/arch/arm/include/asm/neon.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#ifndef __ASM_ARM_NEON_H
+#define __ASM_ARM_NEON_H
+
+#include <asm/hwcap.h>
+
+#define cpu_has_neon()		(!!(elf_hwcap & HWCAP_NEON))
+
+/*
+ * NEON code must be kept in a separate compilation unit built with
+ * -mfpu=neon, and only be called from another unit between
+ * kernel_neon_begin() and kernel_neon_end(). This prevents GCC from
+ * moving NEON instructions outside of the region in which the unit is
+ * owned by the kernel.
+ */
+#ifndef __ARM_NEON__
+void kernel_neon_begin(void);
+void kernel_neon_end(void);
+#endif
+
+#endif /* __ASM_ARM_NEON_H */
@@ -0,0 +1,51 @@
+/*
+ *  arch/arm/include/asm/timepage.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Layout of the page exported by /dev/timepage, see
+ * Documentation/arm/timepage.txt.
+ */
+#ifndef __ASM_ARM_TIMEPAGE_H
+#define __ASM_ARM_TIMEPAGE_H
+
+#include <linux/types.h>
+
+#define TIMEPAGE_VERSION	1
+
+/*
+ * Offsets of the two pages in the /dev/timepage mapping.
+ */
+#define TIMEPAGE_DATA_OFFSET	0
+#define TIMEPAGE_COUNTER_OFFSET	4096
+
+struct timepage_data {
+	__u32	seq;		/* odd while the kernel updates the page */
+	__u32	version;	/* TIMEPAGE_VERSION */
+	__u32	counter_valid;	/* counter page holds the current clock */
+	__u32	counter_offset;	/* of the 32-bit counter in its page */
+	__u64	cycle_last;	/* counter value at wall_time */
+	__u64	mask;		/* counter mask */
+	__u32	mult;		/* cycles to ns multiplier */
+	__u32	shift;		/* and shift */
+	__u32	wall_time_sec;	/* CLOCK_REALTIME at cycle_last */
+	__u32	wall_time_nsec;
+	__s32	wtm_sec;	/* wall_to_monotonic */
+	__s32	wtm_nsec;
+	__s32	tz_minuteswest;	/* struct timezone */
+	__s32	tz_dsttime;
+};
+
+#ifdef __KERNEL__
+#ifdef CONFIG_ARM_TIMEPAGE
+extern void timepage_set_counter(const char *name, unsigned long phys);
+#else
+static inline void timepage_set_counter(const char *name, unsigned long phys)
+{
+}
+#endif
+#endif /* __KERNEL__ */
+
+#endif /* __ASM_ARM_TIMEPAGE_H */
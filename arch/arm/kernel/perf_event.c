@@ -30,9 +30,12 @@ static struct platform_device *pmu_device;
 
 /*
  * Hardware lock to serialize accesses to PMU registers. Needed for the
- * read/modify/write sequences.
+ * read/modify/write sequences. The registers are banked per CPU, so the
+ * lock is too: CPUs scheduling their own counters don't contend.
+ * ->start()/->stop() are called preemptible, so users disable interrupts
+ * first and look the lock up once, for both the lock and the unlock.
  */
-static DEFINE_RAW_SPINLOCK(pmu_lock);
+static DEFINE_PER_CPU(raw_spinlock_t, pmu_lock);
 
 /*
  * ARMv6 supports a maximum of 3 events, starting from index 1. If we add
@@ -582,24 +585,18 @@ static int armpmu_event_init(struct perf_event *event)
 
 static void armpmu_enable(struct pmu *pmu)
 {
-	/* Enable all of the perf events on hardware. */
-	int idx, enabled = 0;
 	struct cpu_hw_events *cpuc = &__get_cpu_var(cpu_hw_events);
 
 	if (!armpmu)
 		return;
 
-	for (idx = 0; idx <= armpmu->num_events; ++idx) {
-		struct perf_event *event = cpuc->events[idx];
-
-		if (!event)
-			continue;
-
-		armpmu->enable(&event->hw, idx);
-		enabled = 1;
-	}
-
-	if (enabled)
+	/*
+	 * The counters were programmed by armpmu_start() and are only
+	 * gated by the global enable here, so multiplexing costs one
+	 * register write per rotation rather than one per counter, and
+	 * counters stopped by throttling stay stopped.
+	 */
+	if (!bitmap_empty(cpuc->used_mask, ARMPMU_MAX_HWEVENTS))
 		armpmu->start();
 }
 
@@ -644,6 +641,10 @@ init_hw_perf_events(void)
 	unsigned long cpuid = read_cpuid_id();
 	unsigned long implementor = (cpuid & 0xFF000000) >> 24;
 	unsigned long part_number = (cpuid & 0xFFF0);
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		raw_spin_lock_init(&per_cpu(pmu_lock, cpu));
 
 	/* ARM Ltd CPUs. */
 	if (0x41 == implementor) {
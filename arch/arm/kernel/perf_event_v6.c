@@ -405,6 +405,7 @@ armv6pmu_enable_event(struct hw_perf_event *hwc,
 		      int idx)
 {
 	unsigned long val, mask, evt, flags;
+	raw_spinlock_t *lock;
 
 	if (ARMV6_CYCLE_COUNTER == idx) {
 		mask	= 0;
@@ -426,12 +427,14 @@ armv6pmu_enable_event(struct hw_perf_event *hwc,
 	 * Mask out the current event and set the counter to count the event
 	 * that we're interested in.
 	 */
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = armv6_pmcr_read();
 	val &= ~mask;
 	val |= evt;
 	armv6_pmcr_write(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static irqreturn_t
@@ -499,24 +502,30 @@ static void
 armv6pmu_start(void)
 {
 	unsigned long flags, val;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = armv6_pmcr_read();
 	val |= ARMV6_PMCR_ENABLE;
 	armv6_pmcr_write(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void
 armv6pmu_stop(void)
 {
 	unsigned long flags, val;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = armv6_pmcr_read();
 	val &= ~ARMV6_PMCR_ENABLE;
 	armv6_pmcr_write(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static int
@@ -550,6 +559,7 @@ armv6pmu_disable_event(struct hw_perf_event *hwc,
 		       int idx)
 {
 	unsigned long val, mask, evt, flags;
+	raw_spinlock_t *lock;
 
 	if (ARMV6_CYCLE_COUNTER == idx) {
 		mask	= ARMV6_PMCR_CCOUNT_IEN;
@@ -570,12 +580,14 @@ armv6pmu_disable_event(struct hw_perf_event *hwc,
 	 * of ETM bus signal assertion cycles. The external reporting should
 	 * be disabled and so this should never increment.
 	 */
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = armv6_pmcr_read();
 	val &= ~mask;
 	val |= evt;
 	armv6_pmcr_write(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void
@@ -583,6 +595,7 @@ armv6mpcore_pmu_disable_event(struct hw_perf_event *hwc,
 			      int idx)
 {
 	unsigned long val, mask, flags, evt = 0;
+	raw_spinlock_t *lock;
 
 	if (ARMV6_CYCLE_COUNTER == idx) {
 		mask	= ARMV6_PMCR_CCOUNT_IEN;
@@ -599,12 +612,14 @@ armv6mpcore_pmu_disable_event(struct hw_perf_event *hwc,
 	 * Unlike UP ARMv6, we don't have a way of stopping the counters. We
 	 * simply disable the interrupt reporting.
 	 */
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = armv6_pmcr_read();
 	val &= ~mask;
 	val |= evt;
 	armv6_pmcr_write(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static const struct arm_pmu armv6pmu = {
@@ -686,12 +686,15 @@ static void armv7_pmnc_dump_regs(void)
 static void armv7pmu_enable_event(struct hw_perf_event *hwc, int idx)
 {
 	unsigned long flags;
+	raw_spinlock_t *lock;
 
 	/*
 	 * Enable counter and interrupt, and set the counter to count
 	 * the event that we're interested in.
 	 */
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 
 	/*
 	 * Disable counter
@@ -715,17 +718,20 @@ static void armv7pmu_enable_event(struct hw_perf_event *hwc, int idx)
 	 */
 	armv7_pmnc_enable_counter(idx);
 
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void armv7pmu_disable_event(struct hw_perf_event *hwc, int idx)
 {
 	unsigned long flags;
+	raw_spinlock_t *lock;
 
 	/*
 	 * Disable counter and interrupt
 	 */
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 
 	/*
 	 * Disable counter
@@ -737,7 +743,7 @@ static void armv7pmu_disable_event(struct hw_perf_event *hwc, int idx)
 	 */
 	armv7_pmnc_disable_intens(idx);
 
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static irqreturn_t armv7pmu_handle_irq(int irq_num, void *dev)
@@ -806,21 +812,27 @@ static irqreturn_t armv7pmu_handle_irq(int irq_num, void *dev)
 static void armv7pmu_start(void)
 {
 	unsigned long flags;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	/* Enable all counters */
 	armv7_pmnc_write(armv7_pmnc_read() | ARMV7_PMNC_E);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void armv7pmu_stop(void)
 {
 	unsigned long flags;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	/* Disable all counters */
 	armv7_pmnc_write(armv7_pmnc_read() & ~ARMV7_PMNC_E);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static int armv7pmu_get_event_idx(struct cpu_hw_events *cpuc,
@@ -270,6 +270,7 @@ static void
 xscale1pmu_enable_event(struct hw_perf_event *hwc, int idx)
 {
 	unsigned long val, mask, evt, flags;
+	raw_spinlock_t *lock;
 
 	switch (idx) {
 	case XSCALE_CYCLE_COUNTER:
@@ -291,18 +292,21 @@ xscale1pmu_enable_event(struct hw_perf_event *hwc, int idx)
 		return;
 	}
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = xscale1pmu_read_pmnc();
 	val &= ~mask;
 	val |= evt;
 	xscale1pmu_write_pmnc(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void
 xscale1pmu_disable_event(struct hw_perf_event *hwc, int idx)
 {
 	unsigned long val, mask, evt, flags;
+	raw_spinlock_t *lock;
 
 	switch (idx) {
 	case XSCALE_CYCLE_COUNTER:
@@ -322,12 +326,14 @@ xscale1pmu_disable_event(struct hw_perf_event *hwc, int idx)
 		return;
 	}
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = xscale1pmu_read_pmnc();
 	val &= ~mask;
 	val |= evt;
 	xscale1pmu_write_pmnc(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static int
@@ -354,24 +360,30 @@ static void
 xscale1pmu_start(void)
 {
 	unsigned long flags, val;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = xscale1pmu_read_pmnc();
 	val |= XSCALE_PMU_ENABLE;
 	xscale1pmu_write_pmnc(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void
 xscale1pmu_stop(void)
 {
 	unsigned long flags, val;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = xscale1pmu_read_pmnc();
 	val &= ~XSCALE_PMU_ENABLE;
 	xscale1pmu_write_pmnc(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static inline u32
@@ -602,6 +614,7 @@ static void
 xscale2pmu_enable_event(struct hw_perf_event *hwc, int idx)
 {
 	unsigned long flags, ien, evtsel;
+	raw_spinlock_t *lock;
 
 	ien = xscale2pmu_read_int_enable();
 	evtsel = xscale2pmu_read_event_select();
@@ -635,16 +648,19 @@ xscale2pmu_enable_event(struct hw_perf_event *hwc, int idx)
 		return;
 	}
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	xscale2pmu_write_event_select(evtsel);
 	xscale2pmu_write_int_enable(ien);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void
 xscale2pmu_disable_event(struct hw_perf_event *hwc, int idx)
 {
 	unsigned long flags, ien, evtsel;
+	raw_spinlock_t *lock;
 
 	ien = xscale2pmu_read_int_enable();
 	evtsel = xscale2pmu_read_event_select();
@@ -678,10 +694,12 @@ xscale2pmu_disable_event(struct hw_perf_event *hwc, int idx)
 		return;
 	}
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	xscale2pmu_write_event_select(evtsel);
 	xscale2pmu_write_int_enable(ien);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static int
@@ -704,24 +722,30 @@ static void
 xscale2pmu_start(void)
 {
 	unsigned long flags, val;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = xscale2pmu_read_pmnc() & ~XSCALE_PMU_CNT64;
 	val |= XSCALE_PMU_ENABLE;
 	xscale2pmu_write_pmnc(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static void
 xscale2pmu_stop(void)
 {
 	unsigned long flags, val;
+	raw_spinlock_t *lock;
 
-	raw_spin_lock_irqsave(&pmu_lock, flags);
+	local_irq_save(flags);
+	lock = &__get_cpu_var(pmu_lock);
+	raw_spin_lock(lock);
 	val = xscale2pmu_read_pmnc();
 	val &= ~XSCALE_PMU_ENABLE;
 	xscale2pmu_write_pmnc(val);
-	raw_spin_unlock_irqrestore(&pmu_lock, flags);
+	raw_spin_unlock_irqrestore(lock, flags);
 }
 
 static inline u32
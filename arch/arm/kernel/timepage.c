@@ -0,0 +1,165 @@
+/*
+ *  linux/arch/arm/kernel/timepage.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ *  User space time page.  The timekeeping state needed to turn a counter
+ *  value into the time of day is published in a page which user space
+ *  maps read only from /dev/timepage.  If the platform told us where the
+ *  counter of the current clocksource lives, the register page holding it
+ *  is mapped right behind, so that clock_gettime() and gettimeofday() can
+ *  be done in user space without entering the kernel.
+ *
+ *  See Documentation/arm/timepage.txt.
+ */
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/clocksource.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/time.h>
+
+#include <asm/timepage.h>
+
+static union {
+	struct timepage_data	data;
+	u8			page[PAGE_SIZE];
+} timepage __page_aligned_data = {
+	.data.version	= TIMEPAGE_VERSION,
+};
+
+static DEFINE_SPINLOCK(timepage_lock);
+
+static const char *timepage_counter_name;
+static unsigned long timepage_counter_phys;
+static struct clocksource *timepage_cs;
+
+/**
+ * timepage_set_counter - export a clocksource counter to user space
+ * @name:	name of the clocksource
+ * @phys:	physical address of its 32-bit counter register
+ *
+ * The register page is mapped read only into user space, it must not
+ * hold registers with read side effects.
+ */
+void __init timepage_set_counter(const char *name, unsigned long phys)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&timepage_lock, flags);
+	timepage_counter_name = name;
+	timepage_counter_phys = phys;
+	/* look at the current clocksource again on the next update */
+	timepage_cs = NULL;
+	spin_unlock_irqrestore(&timepage_lock, flags);
+}
+
+static inline void timepage_write_begin(struct timepage_data *tp)
+{
+	tp->seq++;
+	smp_wmb();
+}
+
+static inline void timepage_write_end(struct timepage_data *tp)
+{
+	smp_wmb();
+	tp->seq++;
+}
+
+void update_vsyscall(struct timespec *ts, struct timespec *wtm,
+		     struct clocksource *c, u32 mult)
+{
+	struct timepage_data *tp = &timepage.data;
+	unsigned long flags;
+
+	spin_lock_irqsave(&timepage_lock, flags);
+	timepage_write_begin(tp);
+
+	if (c != timepage_cs) {
+		timepage_cs = c;
+		tp->counter_valid = timepage_counter_name &&
+			!strcmp(c->name, timepage_counter_name);
+		tp->counter_offset = timepage_counter_phys & ~PAGE_MASK;
+	}
+
+	tp->cycle_last = c->cycle_last;
+	tp->mask = c->mask;
+	tp->mult = mult;
+	tp->shift = c->shift;
+	tp->wall_time_sec = ts->tv_sec;
+	tp->wall_time_nsec = ts->tv_nsec;
+	tp->wtm_sec = wtm->tv_sec;
+	tp->wtm_nsec = wtm->tv_nsec;
+
+	timepage_write_end(tp);
+	spin_unlock_irqrestore(&timepage_lock, flags);
+}
+
+void update_vsyscall_tz(void)
+{
+	struct timepage_data *tp = &timepage.data;
+	unsigned long flags;
+
+	spin_lock_irqsave(&timepage_lock, flags);
+	timepage_write_begin(tp);
+	tp->tz_minuteswest = sys_tz.tz_minuteswest;
+	tp->tz_dsttime = sys_tz.tz_dsttime;
+	timepage_write_end(tp);
+	spin_unlock_irqrestore(&timepage_lock, flags);
+}
+
+static int timepage_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	unsigned long size = vma->vm_end - vma->vm_start;
+	int ret;
+
+	if (vma->vm_pgoff || size > 2 * PAGE_SIZE)
+		return -EINVAL;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	ret = remap_pfn_range(vma, vma->vm_start,
+			      virt_to_phys(&timepage) >> PAGE_SHIFT,
+			      PAGE_SIZE, vma->vm_page_prot);
+	if (ret || size == PAGE_SIZE)
+		return ret;
+
+	if (!timepage_counter_phys)
+		return -ENXIO;
+
+	return remap_pfn_range(vma, vma->vm_start + PAGE_SIZE,
+			       timepage_counter_phys >> PAGE_SHIFT, PAGE_SIZE,
+			       pgprot_noncached(vma->vm_page_prot));
+}
+
+static const struct file_operations timepage_fops = {
+	.owner	= THIS_MODULE,
+	.mmap	= timepage_mmap,
+};
+
+static struct miscdevice timepage_miscdev = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= "timepage",
+	.fops	= &timepage_fops,
+	.mode	= S_IRUGO,
+};
+
+static int __init timepage_init(void)
+{
+	int ret;
+
+	ret = misc_register(&timepage_miscdev);
+	if (ret)
+		printk(KERN_ERR "timepage: failed to register device: %d\n",
+		       ret);
+
+	return ret;
+}
+device_initcall(timepage_init);
@@ -0,0 +1,102 @@
+/*
+ * linux/arch/arm/lib/adler32-neon.c
+ *
+ * NEON inner loop for the zlib Adler-32 checksum.  Called through
+ * zlib_adler32_neon() in adler32.c, which owns the NEON unit around it.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+#include <arm_neon.h>
+
+#define BASE	65521U	/* largest prime smaller than 65536 */
+#define NMAX	5552	/* largest n with 255n(n+1)/2 + (n+1)(BASE-1) < 2^32 */
+#define BLOCK	32
+
+/*
+ * Process 'blocks' 32 byte blocks.  Per block, s1 grows by the sum of the
+ * bytes and s2 by 32 * s1 plus the bytes weighted 32..1, so keep four
+ * lanes of byte sums, a running sum of s1 and per-column byte sums that are
+ * weighted once per NMAX chunk.
+ */
+void __adler32_neon(uint32_t *ps1, uint32_t *ps2, const uint8_t *buf,
+		    unsigned int blocks)
+{
+	static const uint16_t weights[32] = {
+		32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+		16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,
+	};
+	uint32_t s1 = *ps1, s2 = *ps2;
+
+	while (blocks) {
+		unsigned int n = NMAX / BLOCK;
+		uint32x4_t v_s1 = vdupq_n_u32(0);
+		uint32x4_t v_s2 = vdupq_n_u32(0);
+		uint16x8_t v_col1 = vdupq_n_u16(0);
+		uint16x8_t v_col2 = vdupq_n_u16(0);
+		uint16x8_t v_col3 = vdupq_n_u16(0);
+		uint16x8_t v_col4 = vdupq_n_u16(0);
+		uint32x2_t sum1, sum2, s1s2;
+
+		if (n > blocks)
+			n = blocks;
+		blocks -= n;
+
+		/* s1 from previous chunks contributes once per byte */
+		v_s2 = vsetq_lane_u32(s1 * n, v_s2, 3);
+
+		do {
+			const uint8x16_t b1 = vld1q_u8(buf);
+			const uint8x16_t b2 = vld1q_u8(buf + 16);
+
+			v_s2 = vaddq_u32(v_s2, v_s1);
+			v_s1 = vpadalq_u16(v_s1,
+					   vpadalq_u8(vpaddlq_u8(b1), b2));
+
+			v_col1 = vaddw_u8(v_col1, vget_low_u8(b1));
+			v_col2 = vaddw_u8(v_col2, vget_high_u8(b1));
+			v_col3 = vaddw_u8(v_col3, vget_low_u8(b2));
+			v_col4 = vaddw_u8(v_col4, vget_high_u8(b2));
+
+			buf += BLOCK;
+		} while (--n);
+
+		v_s2 = vshlq_n_u32(v_s2, 5);
+
+		v_s2 = vmlal_u16(v_s2, vget_low_u16(v_col1),
+				 vld1_u16(&weights[0]));
+		v_s2 = vmlal_u16(v_s2, vget_high_u16(v_col1),
+				 vld1_u16(&weights[4]));
+		v_s2 = vmlal_u16(v_s2, vget_low_u16(v_col2),
+				 vld1_u16(&weights[8]));
+		v_s2 = vmlal_u16(v_s2, vget_high_u16(v_col2),
+				 vld1_u16(&weights[12]));
+		v_s2 = vmlal_u16(v_s2, vget_low_u16(v_col3),
+				 vld1_u16(&weights[16]));
+		v_s2 = vmlal_u16(v_s2, vget_high_u16(v_col3),
+				 vld1_u16(&weights[20]));
+		v_s2 = vmlal_u16(v_s2, vget_low_u16(v_col4),
+				 vld1_u16(&weights[24]));
+		v_s2 = vmlal_u16(v_s2, vget_high_u16(v_col4),
+				 vld1_u16(&weights[28]));
+
+		sum1 = vpadd_u32(vget_low_u32(v_s1), vget_high_u32(v_s1));
+		sum2 = vpadd_u32(vget_low_u32(v_s2), vget_high_u32(v_s2));
+		s1s2 = vpadd_u32(sum1, sum2);
+
+		s1 += vget_lane_u32(s1s2, 0);
+		s2 += vget_lane_u32(s1s2, 1);
+
+		s1 %= BASE;
+		s2 %= BASE;
+	}
+
+	*ps1 = s1;
+	*ps2 = s2;
+}
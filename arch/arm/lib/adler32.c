@@ -0,0 +1,39 @@
+/*
+ * linux/arch/arm/lib/adler32.c
+ *
+ * NEON accelerated Adler-32 for the in-kernel zlib.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#include <linux/hardirq.h>
+#include <linux/module.h>
+#include <linux/zutil.h>
+#include <asm/neon.h>
+
+void __adler32_neon(u32 *ps1, u32 *ps2, const u8 *buf, unsigned int blocks);
+
+/*
+ * Fold as many whole 32 byte blocks of buf as possible into *adler and
+ * return the number of bytes consumed; zlib_adler32() handles the rest.
+ * Returns 0 without touching *adler when NEON cannot be used here.
+ */
+unsigned int zlib_adler32_neon(unsigned long *adler, const unsigned char *buf,
+			       unsigned int len)
+{
+	unsigned int blocks = len / 32;
+	u32 s1 = *adler & 0xffff;
+	u32 s2 = (*adler >> 16) & 0xffff;
+
+	if (!blocks || !cpu_has_neon() || in_interrupt())
+		return 0;
+
+	kernel_neon_begin();
+	__adler32_neon(&s1, &s2, buf, blocks);
+	kernel_neon_end();
+
+	*adler = (s2 << 16) | s1;
+	return blocks * 32;
+}
+EXPORT_SYMBOL(zlib_adler32_neon);
@@ -0,0 +1,134 @@
+/*
+ * linux/arch/arm/lib/xor-neon.c
+ *
+ * NEON inner loops for the XOR block templates in asm/xor.h.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/module.h>
+#include <linux/raid/xor.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+#include <arm_neon.h>
+
+MODULE_LICENSE("GPL");
+
+/*
+ * Each iteration handles one 32 byte line, which matches the granularity
+ * the generic 8regs/32regs templates already require from callers.
+ */
+#define XOR_LINE	32
+
+static void
+xor_neon_2(unsigned long bytes, unsigned long *p1, unsigned long *p2)
+{
+	uint8_t *d = (uint8_t *)p1, *s1 = (uint8_t *)p2;
+	unsigned long lines = bytes / XOR_LINE;
+
+	do {
+		uint8x16_t a0 = vld1q_u8(d), a1 = vld1q_u8(d + 16);
+
+		a0 = veorq_u8(a0, vld1q_u8(s1));
+		a1 = veorq_u8(a1, vld1q_u8(s1 + 16));
+		vst1q_u8(d, a0);
+		vst1q_u8(d + 16, a1);
+
+		d += XOR_LINE;
+		s1 += XOR_LINE;
+	} while (--lines);
+}
+
+static void
+xor_neon_3(unsigned long bytes, unsigned long *p1, unsigned long *p2,
+	   unsigned long *p3)
+{
+	uint8_t *d = (uint8_t *)p1, *s1 = (uint8_t *)p2, *s2 = (uint8_t *)p3;
+	unsigned long lines = bytes / XOR_LINE;
+
+	do {
+		uint8x16_t a0 = vld1q_u8(d), a1 = vld1q_u8(d + 16);
+
+		a0 = veorq_u8(a0, vld1q_u8(s1));
+		a1 = veorq_u8(a1, vld1q_u8(s1 + 16));
+		a0 = veorq_u8(a0, vld1q_u8(s2));
+		a1 = veorq_u8(a1, vld1q_u8(s2 + 16));
+		vst1q_u8(d, a0);
+		vst1q_u8(d + 16, a1);
+
+		d += XOR_LINE;
+		s1 += XOR_LINE;
+		s2 += XOR_LINE;
+	} while (--lines);
+}
+
+static void
+xor_neon_4(unsigned long bytes, unsigned long *p1, unsigned long *p2,
+	   unsigned long *p3, unsigned long *p4)
+{
+	uint8_t *d = (uint8_t *)p1, *s1 = (uint8_t *)p2, *s2 = (uint8_t *)p3;
+	uint8_t *s3 = (uint8_t *)p4;
+	unsigned long lines = bytes / XOR_LINE;
+
+	do {
+		uint8x16_t a0 = vld1q_u8(d), a1 = vld1q_u8(d + 16);
+
+		a0 = veorq_u8(a0, vld1q_u8(s1));
+		a1 = veorq_u8(a1, vld1q_u8(s1 + 16));
+		a0 = veorq_u8(a0, vld1q_u8(s2));
+		a1 = veorq_u8(a1, vld1q_u8(s2 + 16));
+		a0 = veorq_u8(a0, vld1q_u8(s3));
+		a1 = veorq_u8(a1, vld1q_u8(s3 + 16));
+		vst1q_u8(d, a0);
+		vst1q_u8(d + 16, a1);
+
+		d += XOR_LINE;
+		s1 += XOR_LINE;
+		s2 += XOR_LINE;
+		s3 += XOR_LINE;
+	} while (--lines);
+}
+
+static void
+xor_neon_5(unsigned long bytes, unsigned long *p1, unsigned long *p2,
+	   unsigned long *p3, unsigned long *p4, unsigned long *p5)
+{
+	uint8_t *d = (uint8_t *)p1, *s1 = (uint8_t *)p2, *s2 = (uint8_t *)p3;
+	uint8_t *s3 = (uint8_t *)p4, *s4 = (uint8_t *)p5;
+	unsigned long lines = bytes / XOR_LINE;
+
+	do {
+		uint8x16_t a0 = vld1q_u8(d), a1 = vld1q_u8(d + 16);
+
+		a0 = veorq_u8(a0, vld1q_u8(s1));
+		a1 = veorq_u8(a1, vld1q_u8(s1 + 16));
+		a0 = veorq_u8(a0, vld1q_u8(s2));
+		a1 = veorq_u8(a1, vld1q_u8(s2 + 16));
+		a0 = veorq_u8(a0, vld1q_u8(s3));
+		a1 = veorq_u8(a1, vld1q_u8(s3 + 16));
+		a0 = veorq_u8(a0, vld1q_u8(s4));
+		a1 = veorq_u8(a1, vld1q_u8(s4 + 16));
+		vst1q_u8(d, a0);
+		vst1q_u8(d + 16, a1);
+
+		d += XOR_LINE;
+		s1 += XOR_LINE;
+		s2 += XOR_LINE;
+		s3 += XOR_LINE;
+		s4 += XOR_LINE;
+	} while (--lines);
+}
+
+struct xor_block_template const xor_block_neon_inner = {
+	.name	= "__inner_neon__",
+	.do_2	= xor_neon_2,
+	.do_3	= xor_neon_3,
+	.do_4	= xor_neon_4,
+	.do_5	= xor_neon_5,
+};
+EXPORT_SYMBOL(xor_block_neon_inner);
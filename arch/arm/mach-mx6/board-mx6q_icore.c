@@ -1816,6 +1816,16 @@ static void __init mx6_icore_board_init(void)
 	icore_customized_version_init();
 	icore_customized_board_init();
 
+	/*
+	 * The FEC (PHY reset, MDIO scan), uSDHC (card detect) and ADV7180
+	 * (power up, I2C setup) probes are the slowest on this board and
+	 * nothing registered here depends on them, so let them run in
+	 * parallel with the rest of boot.  AHCI is bound synchronously by
+	 * platform_driver_probe(); the HDMI EDID is read from mxcfb_probe(),
+	 * which must stay in order to keep the fb numbering stable.
+	 */
+	driver_async_probe_default("fec,sdhci,adv7180");
+
 	#ifdef CONFIG_MACH_MX6Q_MINIMUM_FREQ400
 	printk("CPU Minum freq forced to 400 Mhz.\n");
 	#endif
@@ -1964,6 +1974,7 @@ static void __init mx6_icore_board_init(void)
 
 	imx6q_add_pcie(&pcie_data);
 
+	imx6_add_armpmu();
 	imx6q_add_perfmon(0);
 	imx6q_add_perfmon(1);
 	imx6q_add_perfmon(2);
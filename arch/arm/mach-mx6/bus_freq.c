@@ -34,6 +34,7 @@
 #include <linux/platform_device.h>
 #include <linux/regulator/consumer.h>
 #include <linux/mutex.h>
+#include <linux/pm_qos_params.h>
 #include <mach/iram.h>
 #include <mach/hardware.h>
 #include <mach/clock.h>
@@ -53,6 +54,16 @@
 #define GPC_PGC_GPU_PGCR_OFFSET	0x260
 #define GPC_CNTR_OFFSET		0x0
 
+/*
+ * PM QoS bounds of the setpoints.  The low setpoint (DDR and AHB at 24MHz,
+ * ARM slowed down in WAIT) is only used while little bandwidth is asked
+ * for and the latency requests are loose; above MED_BUS_MAX_BW the
+ * medium setpoint is skipped.  Bandwidth in kB/s, latency in us.
+ */
+#define LOW_BUS_MAX_BW		20000
+#define LOW_BUS_MIN_LATENCY	500
+#define MED_BUS_MAX_BW		200000
+
 static DEFINE_SPINLOCK(freq_lock);
 
 int low_bus_freq_mode;
@@ -114,6 +125,7 @@ struct clk *mmdc_ch0_axi;
 static struct clk *pll3_540;
 
 static struct delayed_work low_bus_freq_handler;
+static struct work_struct bus_freq_qos_handler;
 
 void reduce_bus_freq(void)
 {
@@ -290,8 +302,13 @@ int set_low_bus_freq(void)
  */
 int set_high_bus_freq(int high_bus_freq)
 {
+	/*
+	 * The QoS and clock paths hold bus_freq_mutex, which the handler
+	 * takes, so don't wait for it: a handler already running rechecks
+	 * low_freq_bus_used() under the mutex and leaves the bus alone.
+	 */
 	if (bus_freq_scaling_initialized && bus_freq_scaling_is_active)
-		cancel_delayed_work_sync(&low_bus_freq_handler);
+		cancel_delayed_work(&low_bus_freq_handler);
 
 	if (busfreq_suspended)
 		return 0;
@@ -303,6 +320,9 @@ int set_high_bus_freq(int high_bus_freq)
 	if (cpu_is_mx6sl())
 		high_bus_freq = 1;
 
+	if (pm_qos_request(PM_QOS_BUS_BANDWIDTH) > MED_BUS_MAX_BW)
+		high_bus_freq = 1;
+
 	if (high_bus_freq_mode && high_bus_freq)
 		return 0;
 
@@ -398,6 +418,10 @@ int low_freq_bus_used(void)
 	if (high_cpu_freq)
 		return 0;
 
+	if (pm_qos_request(PM_QOS_BUS_BANDWIDTH) > LOW_BUS_MAX_BW ||
+	    pm_qos_request(PM_QOS_CPU_DMA_LATENCY) < LOW_BUS_MIN_LATENCY)
+		return 0;
+
 	if ((lp_high_freq == 0)
 	    && (lp_med_freq == 0))
 		return 1;
@@ -552,6 +576,46 @@ static struct notifier_block imx_bus_freq_pm_notifier = {
 	.notifier_call = bus_freq_pm_notify,
 };
 
+/*
+ * Move to the setpoint the PM QoS requests allow.  Like for the clocks,
+ * the bus is raised right away but only lowered through the delayed low
+ * bus freq work.
+ */
+static void bus_freq_qos_update(struct work_struct *work)
+{
+	int high;
+
+	mutex_lock(&bus_freq_mutex);
+
+	high = lp_high_freq ||
+		pm_qos_request(PM_QOS_BUS_BANDWIDTH) > MED_BUS_MAX_BW;
+
+	if (low_freq_bus_used())
+		set_low_bus_freq();
+	else if (low_bus_freq_mode || audio_bus_freq_mode ||
+		 (med_bus_freq_mode && high))
+		set_high_bus_freq(high);
+
+	mutex_unlock(&bus_freq_mutex);
+}
+
+/* Requests are updated from drivers' own locked paths, so defer */
+static int bus_freq_qos_notify(struct notifier_block *nb, unsigned long value,
+	void *dummy)
+{
+	schedule_work(&bus_freq_qos_handler);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block imx_bus_freq_bw_notifier = {
+	.notifier_call = bus_freq_qos_notify,
+};
+
+static struct notifier_block imx_bus_freq_lat_notifier = {
+	.notifier_call = bus_freq_qos_notify,
+};
+
 static DEVICE_ATTR(enable, 0644, bus_freq_scaling_enable_show,
 			bus_freq_scaling_enable_store);
 
@@ -716,6 +780,11 @@ static int __devinit busfreq_probe(struct platform_device *pdev)
 	INIT_DELAYED_WORK(&low_bus_freq_handler, reduce_bus_freq_handler);
 	register_pm_notifier(&imx_bus_freq_pm_notifier);
 
+	INIT_WORK(&bus_freq_qos_handler, bus_freq_qos_update);
+	pm_qos_add_notifier(PM_QOS_BUS_BANDWIDTH, &imx_bus_freq_bw_notifier);
+	pm_qos_add_notifier(PM_QOS_CPU_DMA_LATENCY,
+			    &imx_bus_freq_lat_notifier);
+
 	if (!cpu_is_mx6sl())
 		init_mmdc_settings();
 	else {
@@ -50,7 +50,6 @@ extern int lp_med_freq;
 extern int wait_mode_arm_podf;
 extern int lp_audio_freq;
 extern int cur_arm_podf;
-extern bool enet_is_active;
 
 void __iomem *apll_base;
 
@@ -3461,7 +3460,6 @@ static struct clk can2_clk[] = {
 	.enable = _clk_enable,
 	.disable = _clk_disable,
 	.secondary = &can2_clk[1],
-	.flags = AHB_HIGH_SET_POINT | CPU_FREQ_TRIG_UPDATE,
 	},
 	{
 	 __INIT_CLK_DEBUG(can2_serial_clk)
@@ -3485,7 +3483,6 @@ static struct clk can1_clk[] = {
 	.enable = _clk_enable,
 	.disable = _clk_disable,
 	.secondary = &can1_clk[1],
-	.flags = AHB_HIGH_SET_POINT | CPU_FREQ_TRIG_UPDATE,
 	},
 	{
 	 __INIT_CLK_DEBUG(can1_serial_clk)
@@ -3728,23 +3725,6 @@ static unsigned long _clk_enet_get_rate(struct clk *clk)
 	return 500000000 / div;
 }
 
-static int _clk_enet_enable(struct clk *clk)
-{
-#ifndef CONFIG_MX6_ENET_IRQ_TO_GPIO
-	enet_is_active = true;
-#endif
-	_clk_enable(clk);
-	return 0;
-}
-
-static void _clk_enet_disable(struct clk *clk)
-{
-	_clk_disable(clk);
-#ifndef CONFIG_MX6_ENET_IRQ_TO_GPIO
-	enet_is_active = false;
-#endif
-}
-
 static struct clk enet_clk[] = {
 	{
 	__INIT_CLK_DEBUG(enet_clk)
@@ -3752,12 +3732,11 @@ static struct clk enet_clk[] = {
 	 .parent = &pll8_enet_main_clk,
 	 .enable_reg = MXC_CCM_CCGR1,
 	 .enable_shift = MXC_CCM_CCGRx_CG5_OFFSET,
-	 .enable = _clk_enet_enable,
-	 .disable = _clk_enet_disable,
+	 .enable = _clk_enable,
+	 .disable = _clk_disable,
 	 .set_rate = _clk_enet_set_rate,
 	 .get_rate = _clk_enet_get_rate,
 	.secondary = &enet_clk[1],
-	.flags = AHB_HIGH_SET_POINT | CPU_FREQ_TRIG_UPDATE,
 	},
 	{
 	.parent = &mmdc_ch0_axi_clk[0],
@@ -5389,6 +5368,7 @@ int __init mx6_clocks_init(unsigned long ckil, unsigned long osc,
 	}
 
 	mxc_timer_init(&gpt_clk[0], timer_base, MXC_INT_GPT);
+	mxc_timer_set_user_counter(GPT_BASE_ADDR);
 
 	clk_tree_init();
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2011-2013 Freescale Semiconductor, Inc. All Rights Reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*!
+ * @file cpuidle.c
+ *
+ * @brief MX6 cpuidle driver.
+ *
+ * Two states are offered to the governor:
+ *
+ *	WFI	ARM clock gating only (CLPCR LPM = RUN).  The local timers
+ *		keep running, so the exit is just the interrupt latency.
+ *	WAIT	ARM clock gated by the CCM (CLPCR LPM = WAIT), with the tick
+ *		handed to the broadcast timer and the WAIT mode errata
+ *		workarounds of arch_idle().  Exiting costs the broadcast
+ *		wakeup, the IPI to the sleeping core and the ARM clock restart.
+ *
+ * WAIT is hidden from the governor for an idle period whenever arch_idle()
+ * would not have used it: wait mode disabled on the command line or no
+ * oneshot broadcast device.  The menu governor picks between the two using
+ * the predicted idle time and the PM_QOS_CPU_DMA_LATENCY constraint, which
+ * drivers whose interrupts cannot wait for the WAIT exit keep low.
+ *
+ * @ingroup PM
+ */
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/cpuidle.h>
+#include <linux/hrtimer.h>
+#include <linux/percpu.h>
+#include <linux/smp.h>
+#include <linux/io.h>
+#include <mach/hardware.h>
+
+#define MX6_CPUIDLE_STATE_WFI	0
+#define MX6_CPUIDLE_STATE_WAIT	1
+#define MX6_CPUIDLE_STATE_MAX	2
+
+/*
+ * PROVISIONAL, in us: estimates rather than measurements, as is
+ * MX6_WAIT_EXIT_LATENCY.  The WAIT residency is three times its exit
+ * latency so that the governor only picks it for clearly longer idle
+ * periods.  Check them against the usage and time counters under
+ * /sys/devices/system/cpu/cpuN/cpuidle and a scope on a GPIO toggled
+ * around WFI before tuning anything on top of them.
+ */
+#define MX6_WFI_EXIT_LATENCY		2
+#define MX6_WAIT_TARGET_RESIDENCY	(3 * MX6_WAIT_EXIT_LATENCY)
+
+extern bool mx6_wait_mode_allowed(void);
+extern void mx6_cpu_wait(int cpu);
+extern void mx6_cpu_wfi(void);
+
+static DEFINE_PER_CPU(struct cpuidle_device, mx6_cpuidle_device);
+
+static struct cpuidle_driver mx6_cpuidle_driver = {
+	.name		= "mx6_idle",
+	.owner		= THIS_MODULE,
+};
+
+static int mx6_enter_idle(struct cpuidle_device *dev,
+			  struct cpuidle_state *state)
+{
+	ktime_t before, after;
+
+	/* the idle loop calls us with IRQs disabled */
+	before = ktime_get();
+
+	if (state == &dev->states[MX6_CPUIDLE_STATE_WAIT])
+		mx6_cpu_wait(dev->cpu);
+	else
+		mx6_cpu_wfi();
+
+	after = ktime_get();
+	local_irq_enable();
+
+	return ktime_to_us(ktime_sub(after, before));
+}
+
+static int mx6_cpuidle_prepare(struct cpuidle_device *dev)
+{
+	struct cpuidle_state *wait = &dev->states[MX6_CPUIDLE_STATE_WAIT];
+
+	if (mx6_wait_mode_allowed())
+		wait->flags &= ~CPUIDLE_FLAG_IGNORE;
+	else
+		wait->flags |= CPUIDLE_FLAG_IGNORE;
+
+	return 0;
+}
+
+static void __init mx6_cpuidle_set_states(struct cpuidle_device *dev)
+{
+	struct cpuidle_state *state;
+
+	state = &dev->states[MX6_CPUIDLE_STATE_WFI];
+	strcpy(state->name, "WFI");
+	strcpy(state->desc, "ARM clock gating (WFI)");
+	state->exit_latency = MX6_WFI_EXIT_LATENCY;
+	state->target_residency = 1;
+	state->flags = CPUIDLE_FLAG_TIME_VALID;
+	state->enter = mx6_enter_idle;
+
+	/*
+	 * Budget for the broadcast timer event, the IPI to this core and the
+	 * ARM clock switches of the WAIT mode workaround.
+	 */
+	state = &dev->states[MX6_CPUIDLE_STATE_WAIT];
+	strcpy(state->name, "WAIT");
+	strcpy(state->desc, "ARM clock gated by CCM (WAIT)");
+	state->exit_latency = MX6_WAIT_EXIT_LATENCY;
+	state->target_residency = MX6_WAIT_TARGET_RESIDENCY;
+	state->flags = CPUIDLE_FLAG_TIME_VALID;
+	state->enter = mx6_enter_idle;
+
+	dev->state_count = MX6_CPUIDLE_STATE_MAX;
+	dev->safe_state = &dev->states[MX6_CPUIDLE_STATE_WFI];
+	dev->prepare = mx6_cpuidle_prepare;
+}
+
+static int __init mx6_cpuidle_init(void)
+{
+	struct cpuidle_device *dev;
+	int cpu, ret;
+
+	if (!cpu_is_mx6q() && !cpu_is_mx6dl() && !cpu_is_mx6sl())
+		return -ENODEV;
+
+	ret = cpuidle_register_driver(&mx6_cpuidle_driver);
+	if (ret) {
+		printk(KERN_ERR "mx6_idle: failed to register driver: %d\n", ret);
+		return ret;
+	}
+
+	for_each_possible_cpu(cpu) {
+		dev = &per_cpu(mx6_cpuidle_device, cpu);
+		dev->cpu = cpu;
+		mx6_cpuidle_set_states(dev);
+
+		ret = cpuidle_register_device(dev);
+		if (ret) {
+			printk(KERN_ERR "mx6_idle: failed to register cpu%d: %d\n",
+			       cpu, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+device_initcall(mx6_cpuidle_init);
@@ -63,6 +63,13 @@
 #define MMDC_MDMISC_OFFSET		(MXC_MMDC_P0_BASE + 0x18)
 #define MMDC_MDMISC_DDR_TYPE_MASK	(0x3 << 3)
 #define MMDC_MDMISC_DDR_TYPE_OFFSET	(3)
+#define MMDC_MADPCR0_OFFSET		(MXC_MMDC_P0_BASE + 0x410)
+#define MMDC_MADPCR0_DBG_EN		(1 << 0)
+#define MMDC_MADPCR0_DBG_RST		(1 << 1)
+#define MMDC_MADPCR0_PRF_FRZ		(1 << 2)
+#define MMDC_MADPCR0_CYC_OVF		(1 << 3)
+#define MMDC_MADPCR1_OFFSET		(MXC_MMDC_P0_BASE + 0x414)
+#define MMDC_MADPSR0_OFFSET		(MXC_MMDC_P0_BASE + 0x418)
 
 /* PLLs */
 #define MXC_PLL_BASE			MX6_IO_ADDRESS(ANATOP_BASE_ADDR)
@@ -49,6 +49,11 @@ void __init imx6_init_fec(struct fec_platform_data fec_data)
 	if (!is_valid_ether_addr(fec_data.mac))
 		random_ether_addr(fec_data.mac);
 
+#ifndef CONFIG_MX6_ENET_IRQ_TO_GPIO
+	/* ENET interrupts do not wake the SoC from WAIT mode */
+	fec_data.cpu_dma_latency = MX6_WAIT_EXIT_LATENCY - 1;
+#endif
+
 	if (cpu_is_mx6sl())
 		imx6sl_add_fec(&fec_data);
 	else
@@ -0,0 +1,213 @@
+/*
+ * The code contained herein is licensed under the GNU General Public
+ * License. You may obtain a copy of the GNU General Public License
+ * Version 2 or later at the following locations:
+ *
+ * http://www.opensource.org/licenses/gpl-license.html
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+/*!
+ * @file mx6_mmdc_pmu.c
+ *
+ * @brief MX6 MMDC profiling counters as a perf PMU.
+ *
+ * The MMDC counts, for all AXI masters together, the total and busy
+ * cycles of the DDR controller and the number of read and write accesses
+ * and bytes.  The six counters run together once profiling is enabled,
+ * so any number of events can be active at a time; the config of an
+ * event selects the counter:
+ *
+ *	0 total-cycles	1 busy-cycles	2 read-accesses
+ *	3 write-accesses	4 read-bytes	5 write-bytes
+ *
+ * The counters are 32 bits wide and have no overflow interrupt.  At full
+ * DDR bandwidth the byte counters wrap in about half a second, so they
+ * are polled from an hrtimer.  Events are system wide and are only
+ * accepted on CPU 0, e.g.
+ *
+ *	perf stat -a -C 0 -e mmdc/config=0x4/,mmdc/config=0x5/ ...
+ *
+ * @ingroup PM
+ */
+#include <linux/errno.h>
+#include <linux/hrtimer.h>
+#include <linux/init.h>
+#include <linux/io.h>
+#include <linux/kernel.h>
+#include <linux/perf_event.h>
+#include <mach/hardware.h>
+#include "crm_regs.h"
+
+#define MMDC_PMU_NR_COUNTERS	6
+#define MMDC_PMU_MAX_EVENTS	16
+#define MMDC_PMU_CPU		0
+#define MMDC_PMU_POLL_NS	(100 * NSEC_PER_MSEC)
+
+static struct perf_event *mmdc_pmu_events[MMDC_PMU_MAX_EVENTS];
+static int mmdc_pmu_nr_active;
+static struct hrtimer mmdc_pmu_hrtimer;
+static struct pmu mmdc_pmu;
+
+static inline u32 mmdc_pmu_counter_read(unsigned long counter)
+{
+	return __raw_readl(MMDC_MADPSR0_OFFSET + counter * 4);
+}
+
+static void mmdc_pmu_event_update(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+	u64 prev, now;
+
+	do {
+		prev = local64_read(&hw->prev_count);
+		now = mmdc_pmu_counter_read(hw->config_base);
+	} while (local64_cmpxchg(&hw->prev_count, prev, now) != prev);
+
+	local64_add((now - prev) & 0xffffffff, &event->count);
+}
+
+static enum hrtimer_restart mmdc_pmu_poll(struct hrtimer *hrtimer)
+{
+	int i;
+
+	for (i = 0; i < MMDC_PMU_MAX_EVENTS; i++) {
+		struct perf_event *event = mmdc_pmu_events[i];
+
+		if (event && !(event->hw.state & PERF_HES_STOPPED))
+			mmdc_pmu_event_update(event);
+	}
+
+	/* the cycle counter wraps like the others, nothing to do but ack */
+	if (__raw_readl(MMDC_MADPCR0_OFFSET) & MMDC_MADPCR0_CYC_OVF)
+		__raw_writel(MMDC_MADPCR0_DBG_EN | MMDC_MADPCR0_CYC_OVF,
+			     MMDC_MADPCR0_OFFSET);
+
+	hrtimer_forward_now(hrtimer, ns_to_ktime(MMDC_PMU_POLL_NS));
+	return HRTIMER_RESTART;
+}
+
+static int mmdc_pmu_event_init(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (event->attr.type != mmdc_pmu.type)
+		return -ENOENT;
+
+	if (is_sampling_event(event))
+		return -EOPNOTSUPP;
+	if (event->attr.exclude_user || event->attr.exclude_kernel ||
+	    event->attr.exclude_hv || event->attr.exclude_idle)
+		return -EINVAL;
+
+	if (event->cpu != MMDC_PMU_CPU)
+		return -EINVAL;
+
+	if (event->attr.config >= MMDC_PMU_NR_COUNTERS)
+		return -EINVAL;
+
+	hw->config_base = event->attr.config;
+	hw->idx = -1;
+	return 0;
+}
+
+static void mmdc_pmu_event_start(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (WARN_ON_ONCE(!(hw->state & PERF_HES_STOPPED)))
+		return;
+
+	hw->state = 0;
+	local64_set(&hw->prev_count, mmdc_pmu_counter_read(hw->config_base));
+}
+
+static void mmdc_pmu_event_stop(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (hw->state & PERF_HES_STOPPED)
+		return;
+
+	mmdc_pmu_event_update(event);
+	hw->state |= PERF_HES_STOPPED | PERF_HES_UPTODATE;
+}
+
+static int mmdc_pmu_event_add(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+	int idx;
+
+	for (idx = 0; idx < MMDC_PMU_MAX_EVENTS; idx++)
+		if (!mmdc_pmu_events[idx])
+			break;
+	if (idx == MMDC_PMU_MAX_EVENTS)
+		return -EAGAIN;
+
+	mmdc_pmu_events[idx] = event;
+	hw->idx = idx;
+	hw->state = PERF_HES_STOPPED | PERF_HES_UPTODATE;
+
+	if (!mmdc_pmu_nr_active++) {
+		/* count the accesses of all AXI IDs */
+		__raw_writel(0, MMDC_MADPCR1_OFFSET);
+		__raw_writel(MMDC_MADPCR0_DBG_RST, MMDC_MADPCR0_OFFSET);
+		__raw_writel(MMDC_MADPCR0_DBG_EN, MMDC_MADPCR0_OFFSET);
+		hrtimer_start(&mmdc_pmu_hrtimer, ns_to_ktime(MMDC_PMU_POLL_NS),
+			      HRTIMER_MODE_REL_PINNED);
+	}
+
+	if (flags & PERF_EF_START)
+		mmdc_pmu_event_start(event, 0);
+
+	return 0;
+}
+
+static void mmdc_pmu_event_del(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	mmdc_pmu_event_stop(event, PERF_EF_UPDATE);
+
+	mmdc_pmu_events[hw->idx] = NULL;
+	hw->idx = -1;
+
+	if (!--mmdc_pmu_nr_active) {
+		hrtimer_cancel(&mmdc_pmu_hrtimer);
+		__raw_writel(0, MMDC_MADPCR0_OFFSET);
+	}
+}
+
+static void mmdc_pmu_event_read(struct perf_event *event)
+{
+	if (!(event->hw.state & PERF_HES_STOPPED))
+		mmdc_pmu_event_update(event);
+}
+
+static struct pmu mmdc_pmu = {
+	.task_ctx_nr	= perf_invalid_context,
+	.event_init	= mmdc_pmu_event_init,
+	.add		= mmdc_pmu_event_add,
+	.del		= mmdc_pmu_event_del,
+	.start		= mmdc_pmu_event_start,
+	.stop		= mmdc_pmu_event_stop,
+	.read		= mmdc_pmu_event_read,
+};
+
+static int __init mx6_mmdc_pmu_init(void)
+{
+	int ret;
+
+	/* the boot loader may have left profiling running */
+	__raw_writel(0, MMDC_MADPCR0_OFFSET);
+
+	hrtimer_init(&mmdc_pmu_hrtimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	mmdc_pmu_hrtimer.function = mmdc_pmu_poll;
+
+	ret = perf_pmu_register(&mmdc_pmu, "mmdc", -1);
+	if (ret)
+		printk(KERN_ERR "mmdc: failed to register PMU: %d\n", ret);
+
+	return ret;
+}
+device_initcall(mx6_mmdc_pmu_init);
@@ -23,6 +23,7 @@
 #include <linux/proc_fs.h>
 #include <linux/iram_alloc.h>
 #include <linux/fsl_devices.h>
+#include <linux/clockchips.h>
 #include <asm/mach-types.h>
 #include <asm/cacheflush.h>
 #include <asm/tlb.h>
@@ -489,6 +490,14 @@ static int __init pm_init(void)
 	pr_info("wait mode is %s for i.MX6\n", enable_wait_mode ?
 			"enabled" : "disabled");
 
+	/*
+	 * A cpu in WAIT needs MX6_WAIT_EXIT_LATENCY to get going, so the
+	 * broadcast may wake it that early to share an interrupt with
+	 * the other cores.
+	 */
+	if (enable_wait_mode)
+		tick_broadcast_set_slack(MX6_WAIT_EXIT_LATENCY * NSEC_PER_USEC);
+
 	if (platform_driver_register(&mx6_pm_driver) != 0) {
 		printk(KERN_ERR "mx6_pm_driver register failed\n");
 		return -ENODEV;
@@ -25,6 +25,7 @@
 #include <linux/clockchips.h>
 #include <linux/hrtimer.h>
 #include <linux/tick.h>
+#include <linux/pm_qos_params.h>
 #include <asm/io.h>
 #include <mach/hardware.h>
 #include <mach/clock.h>
@@ -57,7 +58,6 @@ volatile unsigned int num_cpu_idle;
 volatile unsigned int num_cpu_idle_lock = 0x0;
 int wait_mode_arm_podf;
 int cur_arm_podf;
-bool enet_is_active;
 void arch_idle_with_workaround(int cpu);
 
 extern void *mx6sl_wfi_iram_base;
@@ -393,54 +393,77 @@ void arch_idle_multi_core(int cpu)
 		arch_idle_with_workaround(cpu);
 }
 
-void arch_idle(void)
+/*
+ * WAIT mode gates the ARM clock and with it the local timers, so it can
+ * only be entered once the tick has been handed to the broadcast timer.
+ * Drivers that cannot wait for the exit say so with a PM QoS request.
+ */
+bool mx6_wait_mode_allowed(void)
 {
-	int cpu = smp_processor_id();
-
-	if (enable_wait_mode) {
+	if (!enable_wait_mode)
+		return false;
+	if (pm_qos_request(PM_QOS_CPU_DMA_LATENCY) < MX6_WAIT_EXIT_LATENCY)
+		return false;
 #ifdef CONFIG_LOCAL_TIMERS
-		if (!tick_broadcast_oneshot_active()
-			|| !tick_oneshot_mode_active())
-			return;
-
-		clockevents_notify(CLOCK_EVT_NOTIFY_BROADCAST_ENTER, &cpu);
+	if (!tick_broadcast_oneshot_active()
+		|| !tick_oneshot_mode_active())
+		return false;
 #endif
-		if (enet_is_active)
-			/* Don't allow the chip to enter WAIT mode if enet is active
-			  * and the GPIO workaround for ENET interrupts is not used,
-			  * since all ENET interrupts donot wake up the SOC.
-			  */
-			mxc_cpu_lp_set(WAIT_CLOCKED);
-		else
-			mxc_cpu_lp_set(WAIT_UNCLOCKED_POWER_OFF);
-		if (mem_clk_on_in_wait) {
-			u32 reg;
-			/*
-			  * MX6SL, MX6Q (TO1.2 or later) and
-			  * MX6DL (TO1.1 or later) have a bit in
-			  * CCM_CGPR that when cleared keeps the
-			  * clocks to memories ON when ARM is in WFI.
-			  * This mode can be used when IPG clock is
-			  * very low (12MHz) and the ARM:IPG ratio
-			  * perhaps cannot be maintained.
-			  */
-			reg = __raw_readl(MXC_CCM_CGPR);
-			reg &= ~MXC_CCM_CGPR_MEM_IPG_STOP_MASK;
-			__raw_writel(reg, MXC_CCM_CGPR);
+	return true;
+}
 
-			ca9_do_idle();
-		} else if (num_possible_cpus() == 1)
-			/* iMX6SL or iMX6DLS */
-			arch_idle_single_core();
-		else
-			arch_idle_multi_core(cpu);
+/* Enter WAIT mode with the MX6 WAIT mode workarounds, IRQs disabled */
+void mx6_cpu_wait(int cpu)
+{
 #ifdef CONFIG_LOCAL_TIMERS
-		clockevents_notify(CLOCK_EVT_NOTIFY_BROADCAST_EXIT, &cpu);
+	clockevents_notify(CLOCK_EVT_NOTIFY_BROADCAST_ENTER, &cpu);
 #endif
-	}  else {
-		mxc_cpu_lp_set(WAIT_CLOCKED);
+	mxc_cpu_lp_set(WAIT_UNCLOCKED_POWER_OFF);
+	if (mem_clk_on_in_wait) {
+		u32 reg;
+		/*
+		  * MX6SL, MX6Q (TO1.2 or later) and
+		  * MX6DL (TO1.1 or later) have a bit in
+		  * CCM_CGPR that when cleared keeps the
+		  * clocks to memories ON when ARM is in WFI.
+		  * This mode can be used when IPG clock is
+		  * very low (12MHz) and the ARM:IPG ratio
+		  * perhaps cannot be maintained.
+		  */
+		reg = __raw_readl(MXC_CCM_CGPR);
+		reg &= ~MXC_CCM_CGPR_MEM_IPG_STOP_MASK;
+		__raw_writel(reg, MXC_CCM_CGPR);
+
 		ca9_do_idle();
-	}
+	} else if (num_possible_cpus() == 1)
+		/* iMX6SL or iMX6DLS */
+		arch_idle_single_core();
+	else
+		arch_idle_multi_core(cpu);
+#ifdef CONFIG_LOCAL_TIMERS
+	clockevents_notify(CLOCK_EVT_NOTIFY_BROADCAST_EXIT, &cpu);
+#endif
+}
+
+/* ARM clock gating only, the local timers keep running */
+void mx6_cpu_wfi(void)
+{
+	mxc_cpu_lp_set(WAIT_CLOCKED);
+	ca9_do_idle();
+}
+
+/*
+ * Used when CONFIG_CPU_IDLE is off or the mx6 cpuidle driver is not
+ * registered; otherwise the states in cpuidle.c are chosen per idle period.
+ */
+void arch_idle(void)
+{
+	int cpu = smp_processor_id();
+
+	if (mx6_wait_mode_allowed())
+		mx6_cpu_wait(cpu);
+	else
+		mx6_cpu_wfi();
 }
 
 static int __mxs_reset_block(void __iomem *hwreg, int just_enable)
@@ -0,0 +1,257 @@
+/*
+ * arch/arm/mm/cache-l2x0-pmu.c - PL310 event counters as a perf PMU
+ *
+ * The PL310 has two 32-bit event counters, each of which can count one
+ * of fifteen events (hits, requests and castouts for data and
+ * instruction accesses, prefetches and speculative reads).  They are
+ * shared by all cores, so the PMU only takes CPU-bound events on CPU 0.
+ * The counters are polled from an hrtimer instead of using the overflow
+ * interrupt: at the L2 clock rate they wrap after several seconds.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#include <linux/errno.h>
+#include <linux/hrtimer.h>
+#include <linux/init.h>
+#include <linux/io.h>
+#include <linux/kernel.h>
+#include <linux/perf_event.h>
+
+#include <asm/hardware/cache-l2x0.h>
+
+#define L2X0_PMU_NR_COUNTERS	2
+#define L2X0_PMU_EVENT_MAX	15
+#define L2X0_PMU_CPU		0
+#define L2X0_PMU_POLL_NS	NSEC_PER_SEC
+
+static void __iomem *l2x0_pmu_base;
+static struct perf_event *l2x0_pmu_events[L2X0_PMU_NR_COUNTERS];
+static int l2x0_pmu_nr_active;
+static struct hrtimer l2x0_pmu_hrtimer;
+static struct pmu l2x0_pmu;
+
+static inline u32 l2x0_pmu_counter_read(int idx)
+{
+	return readl_relaxed(l2x0_pmu_base +
+		(idx ? L2X0_EVENT_CNT1_VAL : L2X0_EVENT_CNT0_VAL));
+}
+
+static inline void l2x0_pmu_counter_config(int idx, u32 event)
+{
+	writel_relaxed(event << L2X0_EVENT_CNT_CFG_SRC_SHIFT, l2x0_pmu_base +
+		(idx ? L2X0_EVENT_CNT1_CFG : L2X0_EVENT_CNT0_CFG));
+}
+
+static void l2x0_pmu_event_update(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+	u64 prev, now;
+
+	do {
+		prev = local64_read(&hw->prev_count);
+		now = l2x0_pmu_counter_read(hw->idx);
+	} while (local64_cmpxchg(&hw->prev_count, prev, now) != prev);
+
+	local64_add((now - prev) & 0xffffffff, &event->count);
+}
+
+static enum hrtimer_restart l2x0_pmu_poll(struct hrtimer *hrtimer)
+{
+	int i;
+
+	for (i = 0; i < L2X0_PMU_NR_COUNTERS; i++) {
+		struct perf_event *event = l2x0_pmu_events[i];
+
+		if (event && !(event->hw.state & PERF_HES_STOPPED))
+			l2x0_pmu_event_update(event);
+	}
+
+	hrtimer_forward_now(hrtimer, ns_to_ktime(L2X0_PMU_POLL_NS));
+	return HRTIMER_RESTART;
+}
+
+/* Hardware events of other PMUs can't be scheduled with ours */
+static bool l2x0_pmu_group_is_valid(struct perf_event *event)
+{
+	struct perf_event *leader = event->group_leader;
+	struct perf_event *sibling;
+	int counters = 1;
+
+	if (leader != event) {
+		if (leader->pmu == &l2x0_pmu)
+			counters++;
+		else if (!is_software_event(leader))
+			return false;
+	}
+
+	list_for_each_entry(sibling, &leader->sibling_list, group_entry) {
+		if (sibling->pmu == &l2x0_pmu)
+			counters++;
+		else if (!is_software_event(sibling))
+			return false;
+	}
+
+	return counters <= L2X0_PMU_NR_COUNTERS;
+}
+
+static int l2x0_pmu_event_init(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (event->attr.type != l2x0_pmu.type)
+		return -ENOENT;
+
+	/* no overflow interrupt and no notion of the running task */
+	if (is_sampling_event(event))
+		return -EOPNOTSUPP;
+	if (event->attr.exclude_user || event->attr.exclude_kernel ||
+	    event->attr.exclude_hv || event->attr.exclude_idle)
+		return -EINVAL;
+
+	if (event->cpu != L2X0_PMU_CPU)
+		return -EINVAL;
+
+	if (event->attr.config < 1 || event->attr.config > L2X0_PMU_EVENT_MAX)
+		return -EINVAL;
+
+	if (!l2x0_pmu_group_is_valid(event))
+		return -EINVAL;
+
+	hw->config_base = event->attr.config;
+	hw->idx = -1;
+	return 0;
+}
+
+static void l2x0_pmu_event_start(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (WARN_ON_ONCE(!(hw->state & PERF_HES_STOPPED)))
+		return;
+
+	if (flags & PERF_EF_RELOAD)
+		WARN_ON_ONCE(!(hw->state & PERF_HES_UPTODATE));
+
+	hw->state = 0;
+	local64_set(&hw->prev_count, l2x0_pmu_counter_read(hw->idx));
+	l2x0_pmu_counter_config(hw->idx, hw->config_base);
+}
+
+static void l2x0_pmu_event_stop(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (hw->state & PERF_HES_STOPPED)
+		return;
+
+	/* a counter without an event source keeps its value */
+	l2x0_pmu_counter_config(hw->idx, 0);
+	hw->state |= PERF_HES_STOPPED;
+
+	if (flags & PERF_EF_UPDATE) {
+		l2x0_pmu_event_update(event);
+		hw->state |= PERF_HES_UPTODATE;
+	}
+}
+
+static int l2x0_pmu_event_add(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+	int idx;
+
+	for (idx = 0; idx < L2X0_PMU_NR_COUNTERS; idx++)
+		if (!l2x0_pmu_events[idx])
+			break;
+	if (idx == L2X0_PMU_NR_COUNTERS)
+		return -EAGAIN;
+
+	l2x0_pmu_events[idx] = event;
+	hw->idx = idx;
+	hw->state = PERF_HES_STOPPED | PERF_HES_UPTODATE;
+
+	if (!l2x0_pmu_nr_active++) {
+		writel_relaxed(L2X0_EVENT_CNT_ENABLE,
+			       l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+		hrtimer_start(&l2x0_pmu_hrtimer, ns_to_ktime(L2X0_PMU_POLL_NS),
+			      HRTIMER_MODE_REL_PINNED);
+	}
+
+	if (flags & PERF_EF_START)
+		l2x0_pmu_event_start(event, 0);
+
+	return 0;
+}
+
+static void l2x0_pmu_event_del(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	l2x0_pmu_event_stop(event, PERF_EF_UPDATE);
+
+	l2x0_pmu_events[hw->idx] = NULL;
+	hw->idx = -1;
+
+	if (!--l2x0_pmu_nr_active) {
+		hrtimer_cancel(&l2x0_pmu_hrtimer);
+		writel_relaxed(0, l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+	}
+}
+
+static void l2x0_pmu_event_read(struct perf_event *event)
+{
+	if (!(event->hw.state & PERF_HES_STOPPED))
+		l2x0_pmu_event_update(event);
+}
+
+static struct pmu l2x0_pmu = {
+	.task_ctx_nr	= perf_invalid_context,
+	.event_init	= l2x0_pmu_event_init,
+	.add		= l2x0_pmu_event_add,
+	.del		= l2x0_pmu_event_del,
+	.start		= l2x0_pmu_event_start,
+	.stop		= l2x0_pmu_event_stop,
+	.read		= l2x0_pmu_event_read,
+};
+
+/*
+ * Called by l2x0_init(), which may run before the allocators are up;
+ * the PMU itself is registered later from an initcall.
+ */
+void __init l2x0_pmu_register(void __iomem *base, __u32 cache_id)
+{
+	/* the event numbers above are those of the L310 */
+	if ((cache_id & L2X0_CACHE_ID_PART_MASK) != L2X0_CACHE_ID_PART_L310)
+		return;
+
+	l2x0_pmu_base = base;
+}
+
+static int __init l2x0_pmu_init(void)
+{
+	int ret;
+
+	if (!l2x0_pmu_base)
+		return 0;
+
+	/* the boot loader may have left the counters running; stop and zero */
+	writel_relaxed(L2X0_EVENT_CNT_RESET(0) | L2X0_EVENT_CNT_RESET(1),
+		       l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+	l2x0_pmu_counter_config(0, 0);
+	l2x0_pmu_counter_config(1, 0);
+
+	hrtimer_init(&l2x0_pmu_hrtimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	l2x0_pmu_hrtimer.function = l2x0_pmu_poll;
+
+	ret = perf_pmu_register(&l2x0_pmu, "l2x0", -1);
+	if (ret) {
+		pr_err("l2x0: failed to register PMU: %d\n", ret);
+		return ret;
+	}
+
+	pr_info("l2x0: PMU with %d event counters registered\n",
+		L2X0_PMU_NR_COUNTERS);
+	return 0;
+}
+device_initcall(l2x0_pmu_init);
@@ -18,11 +18,46 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <linux/cpumask.h>
+#include <linux/interrupt.h>
+#include <linux/smp.h>
 #include <asm/sizes.h>
 #include <mach/hardware.h>
 #include <mach/devices-common.h>
 #include <asm/pmu.h>
 
+/*
+ * The PMU interrupts of all the Cortex-A9 cores are ORed into one SPI,
+ * which the GIC delivers to a single CPU.  When it is taken on a CPU
+ * whose counters have not overflowed, hand it on to the next online CPU:
+ * the line stays asserted until the owner of the overflow clears its
+ * flags, so each overflow is handled, and sampled, on its own CPU.
+ */
+static irqreturn_t mx6_pmu_handler(int irq, void *dev, irq_handler_t handler)
+{
+	irqreturn_t ret = handler(irq, dev);
+	int cpu = smp_processor_id();
+	int next;
+
+	if (ret == IRQ_NONE) {
+		next = cpumask_next(cpu, cpu_online_mask);
+		if (next >= nr_cpu_ids)
+			next = cpumask_first(cpu_online_mask);
+		if (next != cpu)
+			irq_set_affinity(irq, cpumask_of(next));
+	}
+
+	/*
+	 * At most one IRQ_NONE per other CPU for each handled overflow,
+	 * well below what the spurious interrupt detection reacts to.
+	 */
+	return ret;
+}
+
+static struct arm_pmu_platdata mx6_pmu_platdata = {
+	.handle_irq	= mx6_pmu_handler,
+};
+
 static struct resource mx6_pmu_resources[] = {
 	[0] = {
 		.start	= MXC_INT_CHEETAH_PERFORM,
@@ -36,6 +71,9 @@ struct platform_device mx6_pmu_device = {
 	.id		= ARM_PMU_DEVICE_CPU,
 	.num_resources	= ARRAY_SIZE(mx6_pmu_resources),
 	.resource	= mx6_pmu_resources,
+	.dev		= {
+		.platform_data	= &mx6_pmu_platdata,
+	},
 };
 
 void __init imx_add_imx_armpmu()
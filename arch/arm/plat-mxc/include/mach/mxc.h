@@ -271,6 +271,18 @@ enum mxc_cpu_pwr_mode {
 	ARM_POWER_OFF,		/* STOP + SRPG + ARM power off */
 };
 
+/*
+ * Exit latency of WAIT mode on i.MX6, in us.  PM QoS CPU DMA latency
+ * requests below it keep the cores in WFI.
+ *
+ * PROVISIONAL: an estimate from the steps the exit takes (broadcast
+ * timer event, IPI, ARM clock restart), not a measurement.  The cpuidle
+ * WAIT state, the tick broadcast slack and the FEC and WAIT mode QoS
+ * thresholds all derive from it; measure on the board before relying
+ * on those decisions.
+ */
+#define MX6_WAIT_EXIT_LATENCY	50
+
 int tzic_enable_wake(int is_idle);
 
 extern void mxc_cpu_lp_set(enum mxc_cpu_pwr_mode mode);
@@ -29,6 +29,7 @@
 #include <mach/hardware.h>
 #include <asm/sched_clock.h>
 #include <asm/mach/time.h>
+#include <asm/timepage.h>
 #include <mach/common.h>
 
 /*
@@ -165,6 +166,14 @@ static int v2_set_next_event(unsigned long evt,
 
 	__raw_writel(tcmp, timer_base + V2_TCMP);
 
+	/*
+	 * A compare value the counter already passed only matches after
+	 * the counter wraps, let the caller retry with a later event.
+	 */
+	if (evt < 0x7fffffff &&
+	    (int)(tcmp - __raw_readl(timer_base + V2_TCN)) < 0)
+		return -ETIME;
+
 	return 0;
 }
 
@@ -260,7 +269,8 @@ static irqreturn_t mxc_timer_interrupt(int irq, void *dev_id)
 
 static struct irqaction mxc_timer_irq = {
 	.name		= "i.MX Timer Tick",
-	.flags		= IRQF_DISABLED | IRQF_TIMER | IRQF_IRQPOLL,
+	.flags		= IRQF_DISABLED | IRQF_TIMER | IRQF_IRQPOLL |
+			  IRQF_NOBALANCING,
 	.handler	= mxc_timer_interrupt,
 };
 
@@ -273,7 +283,7 @@ static struct clock_event_device clockevent_mxc = {
 	.rating		= 200,
 };
 
-static int __init mxc_clockevent_init(struct clk *timer_clk)
+static int __init mxc_clockevent_init(struct clk *timer_clk, int irq)
 {
 	unsigned int c = clk_get_rate(timer_clk);
 
@@ -289,6 +299,15 @@ static int __init mxc_clockevent_init(struct clk *timer_clk)
 
 	clockevent_mxc.cpumask = cpumask_of(0);
 
+	/*
+	 * On the SMP parts the GPT is the broadcast device for the local
+	 * timers, its GIC interrupt can follow the cpu with the earliest event.
+	 */
+	if (cpu_is_mx6q() || cpu_is_mx6dl())
+		clockevent_mxc.features |= CLOCK_EVT_FEAT_DYNIRQ;
+
+	clockevent_mxc.irq = irq;
+
 	clockevents_register_device(&clockevent_mxc);
 
 	return 0;
@@ -334,8 +353,18 @@ void __init mxc_timer_init(struct clk *timer_clk, void __iomem *base, int irq)
 
 	/* init and register the timer to the framework */
 	mxc_clocksource_init(timer_clk);
-	mxc_clockevent_init(timer_clk);
+	mxc_clockevent_init(timer_clk, irq);
 
 	/* Make irqs happen */
 	setup_irq(irq, &mxc_timer_irq);
 }
+
+/*
+ * Let user space read the counter through the time page.  The GPT has a
+ * page of its own and none of its registers has read side effects.
+ */
+void __init mxc_timer_set_user_counter(unsigned long phys)
+{
+	timepage_set_counter("mxc_timer1",
+			     phys + (timer_is_v2() ? V2_TCN : MX1_2_TCN));
+}
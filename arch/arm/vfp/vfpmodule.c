@@ -20,6 +20,7 @@
 #include <linux/init.h>
 
 #include <asm/cputype.h>
+#include <asm/neon.h>
 #include <asm/thread_notify.h>
 #include <asm/vfp.h>
 
@@ -502,6 +503,54 @@ void vfp_flush_hwstate(struct thread_info *thread)
 	put_cpu();
 }
 
+#ifdef CONFIG_KERNEL_MODE_NEON
+
+/*
+ * Kernel-side NEON support functions
+ */
+void kernel_neon_begin(void)
+{
+	struct thread_info *thread = current_thread_info();
+	unsigned int cpu;
+	u32 fpexc;
+
+	/*
+	 * Kernel mode NEON is only allowed outside of interrupt context
+	 * with preemption disabled. This will make sure that the kernel
+	 * mode NEON register contents never need to be preserved.
+	 */
+	BUG_ON(in_interrupt());
+	cpu = get_cpu();
+
+	fpexc = fmrx(FPEXC) | FPEXC_EN;
+	fmxr(FPEXC, fpexc);
+
+	/*
+	 * Save the userland NEON/VFP state. Under UP, the owner could be a
+	 * task other than 'current'; under SMP the state of any other owner
+	 * has already been saved at the last thread switch.
+	 */
+	if (last_VFP_context[cpu] == &thread->vfpstate)
+		vfp_save_state(&thread->vfpstate, fpexc);
+#ifndef CONFIG_SMP
+	else if (last_VFP_context[cpu] != NULL)
+		vfp_save_state(last_VFP_context[cpu], fpexc);
+#endif
+	/* Force a reload of the saved state on the next VFP access */
+	last_VFP_context[cpu] = NULL;
+}
+EXPORT_SYMBOL(kernel_neon_begin);
+
+void kernel_neon_end(void)
+{
+	/* Disable the NEON/VFP unit. */
+	fmxr(FPEXC, fmrx(FPEXC) & ~FPEXC_EN);
+	put_cpu();
+}
+EXPORT_SYMBOL(kernel_neon_end);
+
+#endif /* CONFIG_KERNEL_MODE_NEON */
+
 /*
  * VFP hardware can lose all context when a CPU goes offline.
  * As we will be running in SMP mode with CPU hotplug, we will save the
@@ -600,4 +649,8 @@ static int __init vfp_init(void)
 	return 0;
 }
 
-late_initcall(vfp_init);
+/*
+ * Run early so that HWCAP_NEON is known before library code such as the
+ * RAID-6 and XOR block routines benchmarks its implementations.
+ */
+core_initcall(vfp_init);
@@ -1914,8 +1914,10 @@ void blk_dequeue_request(struct request *rq)
 	 * the driver side.
 	 */
 	if (blk_account_rq(rq)) {
+		blk_latency_inflight(q);
 		q->in_flight[rq_is_sync(rq)]++;
 		set_io_start_time_ns(rq);
+		blk_latency_dispatch(rq);
 	}
 }
 
@@ -2206,6 +2208,7 @@ static void blk_finish_request(struct request *req, int error)
 
 
 	blk_account_io_done(req);
+	blk_latency_done(req);
 
 	if (req->end_io)
 		req->end_io(req, error);
@@ -0,0 +1,191 @@
+/*
+ * Request latency and queue depth histograms.
+ *
+ * For every request based queue we keep log2 histograms, in usecs, of the
+ * time requests wait in the queue (allocation to dispatch) and the time
+ * they spend in the device (dispatch to completion), split in read, write
+ * and discard.  The time the queue spends with a given number of requests
+ * in flight is accounted as well.  All of it is updated under the queue
+ * lock and shown in /sys/block/<dev>/queue/latency_hist and inflight_hist.
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/blkdev.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+
+#include "blk.h"
+
+static const char *blk_lat_op_name[BLK_LAT_OPS] = {
+	"read", "write", "discard",
+};
+
+static inline u64 blk_latency_clock(void)
+{
+	u64 now;
+
+	/* see set_start_time_ns() */
+	preempt_disable();
+	now = sched_clock();
+	preempt_enable();
+
+	return now;
+}
+
+static inline int blk_latency_op(struct request *rq)
+{
+	if (rq->cmd_flags & REQ_DISCARD)
+		return 2;
+	return rq_data_dir(rq);
+}
+
+/*
+ * Bucket 0 holds latencies below 1us, bucket n those in [2^(n-1), 2^n) us
+ * and the last one everything longer.
+ */
+static inline int blk_latency_bucket(u64 start, u64 end)
+{
+	u64 usecs;
+	int bucket;
+
+	if (!start || time_before64(end, start))
+		return 0;
+
+	usecs = div_u64(end - start, NSEC_PER_USEC);
+	if (!usecs)
+		return 0;
+
+	bucket = ilog2(usecs) + 1;
+	return min(bucket, BLK_LAT_BUCKETS - 1);
+}
+
+static inline bool blk_latency_rq(struct request *rq)
+{
+	return blk_account_rq(rq) && !(rq->cmd_flags & REQ_FLUSH_SEQ);
+}
+
+/**
+ * blk_latency_inflight - account time spent at the current queue depth
+ * @q:		request queue
+ *
+ * Must be called with the queue lock held before q->in_flight changes.
+ */
+void blk_latency_inflight(struct request_queue *q)
+{
+	struct blk_latency_stats *stats = &q->lat_stats;
+	unsigned int depth = q->in_flight[0] + q->in_flight[1];
+	u64 now = blk_latency_clock();
+
+	if (stats->depth_stamp && time_after64(now, stats->depth_stamp))
+		stats->depth_ns[min(depth, BLK_LAT_DEPTHS - 1U)] +=
+			now - stats->depth_stamp;
+	stats->depth_stamp = now;
+}
+
+/**
+ * blk_latency_dispatch - account the queueing time of a request
+ * @rq:		request which has just been handed to the driver
+ */
+void blk_latency_dispatch(struct request *rq)
+{
+	int bucket;
+
+	if (!blk_latency_rq(rq))
+		return;
+
+	bucket = blk_latency_bucket(rq_start_time_ns(rq),
+				    rq_io_start_time_ns(rq));
+	rq->q->lat_stats.queue[blk_latency_op(rq)][bucket]++;
+}
+
+/**
+ * blk_latency_done - account the device time of a completed request
+ * @rq:		request being finished
+ */
+void blk_latency_done(struct request *rq)
+{
+	int bucket;
+
+	if (!blk_latency_rq(rq) || !rq_io_start_time_ns(rq))
+		return;
+
+	bucket = blk_latency_bucket(rq_io_start_time_ns(rq),
+				    blk_latency_clock());
+	rq->q->lat_stats.device[blk_latency_op(rq)][bucket]++;
+}
+
+ssize_t blk_latency_hist_show(struct request_queue *q, char *page)
+{
+	unsigned int queue[BLK_LAT_OPS][BLK_LAT_BUCKETS];
+	unsigned int device[BLK_LAT_OPS][BLK_LAT_BUCKETS];
+	ssize_t len;
+	int op, i;
+
+	spin_lock_irq(q->queue_lock);
+	memcpy(queue, q->lat_stats.queue, sizeof(queue));
+	memcpy(device, q->lat_stats.device, sizeof(device));
+	spin_unlock_irq(q->queue_lock);
+
+	len = sprintf(page, "%-10s", "usecs");
+	for (op = 0; op < BLK_LAT_OPS; op++)
+		len += sprintf(page + len, " %7s-q %7s-d",
+			       blk_lat_op_name[op], blk_lat_op_name[op]);
+	len += sprintf(page + len, "\n");
+
+	for (i = 0; i < BLK_LAT_BUCKETS; i++) {
+		if (!i)
+			len += sprintf(page + len, "<%-9u", 1);
+		else if (i == BLK_LAT_BUCKETS - 1)
+			len += sprintf(page + len, ">=%-8u", 1U << (i - 1));
+		else
+			len += sprintf(page + len, "%-10u", 1U << (i - 1));
+
+		for (op = 0; op < BLK_LAT_OPS; op++)
+			len += sprintf(page + len, " %9u %9u",
+				       queue[op][i], device[op][i]);
+		len += sprintf(page + len, "\n");
+	}
+
+	return len;
+}
+
+ssize_t blk_latency_hist_store(struct request_queue *q, const char *page,
+			       size_t count)
+{
+	spin_lock_irq(q->queue_lock);
+	memset(q->lat_stats.queue, 0, sizeof(q->lat_stats.queue));
+	memset(q->lat_stats.device, 0, sizeof(q->lat_stats.device));
+	spin_unlock_irq(q->queue_lock);
+
+	return count;
+}
+
+ssize_t blk_inflight_hist_show(struct request_queue *q, char *page)
+{
+	u64 depth_ns[BLK_LAT_DEPTHS];
+	ssize_t len = 0;
+	int i;
+
+	spin_lock_irq(q->queue_lock);
+	blk_latency_inflight(q);
+	memcpy(depth_ns, q->lat_stats.depth_ns, sizeof(depth_ns));
+	spin_unlock_irq(q->queue_lock);
+
+	for (i = 0; i < BLK_LAT_DEPTHS; i++)
+		len += sprintf(page + len, "%s%-3d %llu\n",
+			       i == BLK_LAT_DEPTHS - 1 ? ">=" : "", i,
+			       div_u64(depth_ns[i], NSEC_PER_USEC));
+
+	return len;
+}
+
+ssize_t blk_inflight_hist_store(struct request_queue *q, const char *page,
+				size_t count)
+{
+	spin_lock_irq(q->queue_lock);
+	memset(q->lat_stats.depth_ns, 0, sizeof(q->lat_stats.depth_ns));
+	q->lat_stats.depth_stamp = blk_latency_clock();
+	spin_unlock_irq(q->queue_lock);
+
+	return count;
+}
@@ -380,6 +380,20 @@ static struct queue_sysfs_entry queue_random_entry = {
 	.store = queue_store_random,
 };
 
+#ifdef CONFIG_BLK_DEV_LATENCY_STATS
+static struct queue_sysfs_entry queue_latency_hist_entry = {
+	.attr = {.name = "latency_hist", .mode = S_IRUGO | S_IWUSR },
+	.show = blk_latency_hist_show,
+	.store = blk_latency_hist_store,
+};
+
+static struct queue_sysfs_entry queue_inflight_hist_entry = {
+	.attr = {.name = "inflight_hist", .mode = S_IRUGO | S_IWUSR },
+	.show = blk_inflight_hist_show,
+	.store = blk_inflight_hist_store,
+};
+#endif
+
 static struct attribute *default_attrs[] = {
 	&queue_requests_entry.attr,
 	&queue_ra_entry.attr,
@@ -402,6 +416,10 @@ static struct attribute *default_attrs[] = {
 	&queue_rq_affinity_entry.attr,
 	&queue_iostats_entry.attr,
 	&queue_random_entry.attr,
+#ifdef CONFIG_BLK_DEV_LATENCY_STATS
+	&queue_latency_hist_entry.attr,
+	&queue_inflight_hist_entry.attr,
+#endif
 	NULL,
 };
 
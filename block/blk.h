@@ -116,6 +116,22 @@ static inline int blk_should_fake_timeout(struct request_queue *q)
 }
 #endif
 
+#ifdef CONFIG_BLK_DEV_LATENCY_STATS
+void blk_latency_inflight(struct request_queue *q);
+void blk_latency_dispatch(struct request *rq);
+void blk_latency_done(struct request *rq);
+ssize_t blk_latency_hist_show(struct request_queue *q, char *page);
+ssize_t blk_latency_hist_store(struct request_queue *q, const char *page,
+			       size_t count);
+ssize_t blk_inflight_hist_show(struct request_queue *q, char *page);
+ssize_t blk_inflight_hist_store(struct request_queue *q, const char *page,
+				size_t count);
+#else
+static inline void blk_latency_inflight(struct request_queue *q) { }
+static inline void blk_latency_dispatch(struct request *rq) { }
+static inline void blk_latency_done(struct request *rq) { }
+#endif
+
 struct io_context *current_io_context(gfp_t gfp_flags, int node);
 
 int ll_back_merge_fn(struct request_queue *q, struct request *req,
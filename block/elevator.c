@@ -596,6 +596,7 @@ void elv_requeue_request(struct request_queue *q, struct request *rq)
 	 * in_flight count again
 	 */
 	if (blk_account_rq(rq)) {
+		blk_latency_inflight(q);
 		q->in_flight[rq_is_sync(rq)]--;
 		if (rq->cmd_flags & REQ_SORTED)
 			elv_deactivate_rq(q, rq);
@@ -814,6 +815,7 @@ void elv_completed_request(struct request_queue *q, struct request *rq)
 	 * request is released from the driver, io must be done
 	 */
 	if (blk_account_rq(rq)) {
+		blk_latency_inflight(q);
 		q->in_flight[rq_is_sync(rq)]--;
 		if ((rq->cmd_flags & REQ_SORTED) &&
 		    e->ops->elevator_completed_req_fn)
@@ -0,0 +1,520 @@
+/*
+ *  Flash i/o scheduler.
+ *
+ *  Deadline style scheduler for eMMC and SD cards.  There is no seek cost
+ *  to optimise and no idling: sync requests (reads and sync writes) are
+ *  served first come first served, async writes are collected and issued
+ *  in ascending sector order one erase block at a time, and the two
+ *  classes share the device by time slices.
+ *
+ *  See Documentation/block/flash-iosched.txt
+ */
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/blkdev.h>
+#include <linux/elevator.h>
+#include <linux/bio.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/init.h>
+#include <linux/compiler.h>
+#include <linux/rbtree.h>
+#include <linux/hrtimer.h>
+
+static const int sync_slice = HZ / 10;	/* sync time while async waits */
+static const int async_slice = HZ / 25;	/* async time while sync waits */
+static const int async_batch = 32;	/* max requests of one erase block batch */
+static const int erase_block_kb = 0;	/* 0: use the discard granularity */
+
+#define FLASH_DEFAULT_ERASE_BLOCK	(4096 << 1)	/* sectors */
+
+struct flash_stats {
+	unsigned long completed;
+	u64 total_us;
+	unsigned long max_us;
+};
+
+struct flash_data {
+	struct request_queue *queue;
+
+	/*
+	 * requests are present on both sort_list and fifo_list, indexed
+	 * by BLK_RW_SYNC / BLK_RW_ASYNC
+	 */
+	struct rb_root sort_list[2];
+	struct list_head fifo_list[2];
+
+	int cur_class;			/* class owning the current slice */
+	unsigned long slice_end;	/* jiffies */
+
+	/*
+	 * async erase block batch
+	 */
+	struct request *next_async;	/* next in sort order */
+	sector_t batch_block;		/* erase block being written */
+	sector_t last_sector;		/* end of the last async request */
+	unsigned int batching;
+
+	struct flash_stats stats[2];
+
+	/*
+	 * settings that change how the i/o scheduler behaves
+	 */
+	int slice[2];
+	int async_batch;
+	int erase_block_kb;
+	int front_merges;
+};
+
+static void flash_move_to_dispatch(struct flash_data *, struct request *);
+
+static inline int flash_bio_class(struct bio *bio)
+{
+	return bio_data_dir(bio) == READ || (bio->bi_rw & REQ_SYNC) ?
+		BLK_RW_SYNC : BLK_RW_ASYNC;
+}
+
+static inline struct rb_root *
+flash_rb_root(struct flash_data *fd, struct request *rq)
+{
+	return &fd->sort_list[rq_is_sync(rq)];
+}
+
+static inline struct request *flash_latter_request(struct request *rq)
+{
+	struct rb_node *node = rb_next(&rq->rb_node);
+
+	if (node)
+		return rb_entry_rq(node);
+
+	return NULL;
+}
+
+static inline struct request *flash_former_request(struct request *rq)
+{
+	struct rb_node *node = rb_prev(&rq->rb_node);
+
+	if (node)
+		return rb_entry_rq(node);
+
+	return NULL;
+}
+
+static void flash_add_rq_rb(struct flash_data *fd, struct request *rq)
+{
+	struct rb_root *root = flash_rb_root(fd, rq);
+	struct request *__alias;
+
+	while (unlikely(__alias = elv_rb_add(root, rq)))
+		flash_move_to_dispatch(fd, __alias);
+}
+
+static inline void flash_del_rq_rb(struct flash_data *fd, struct request *rq)
+{
+	if (fd->next_async == rq)
+		fd->next_async = flash_latter_request(rq);
+
+	elv_rb_del(flash_rb_root(fd, rq), rq);
+}
+
+/*
+ * Erase block of a sector.  Unless set explicitly, use the erase unit the
+ * card reported as discard granularity.
+ */
+static sector_t flash_erase_block(struct flash_data *fd, sector_t sector)
+{
+	unsigned int sectors;
+
+	if (fd->erase_block_kb)
+		sectors = fd->erase_block_kb << 1;
+	else if (fd->queue->limits.discard_granularity)
+		sectors = fd->queue->limits.discard_granularity >> 9;
+	else
+		sectors = FLASH_DEFAULT_ERASE_BLOCK;
+
+	sector_div(sector, sectors);
+	return sector;
+}
+
+/*
+ * start a slice for @class
+ */
+static inline void flash_start_slice(struct flash_data *fd, int class)
+{
+	fd->cur_class = class;
+	fd->slice_end = jiffies + fd->slice[class];
+	fd->next_async = NULL;
+}
+
+/*
+ * add rq to rbtree and fifo
+ */
+static void flash_add_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int class = rq_is_sync(rq);
+
+	/*
+	 * Reads get the device first.  The sync slice only starts to count
+	 * once async writes are waiting for it.
+	 */
+	if (class == BLK_RW_ASYNC && fd->cur_class == BLK_RW_SYNC &&
+	    list_empty(&fd->fifo_list[BLK_RW_ASYNC]))
+		fd->slice_end = jiffies + fd->slice[BLK_RW_SYNC];
+
+	flash_add_rq_rb(fd, rq);
+	list_add_tail(&rq->queuelist, &fd->fifo_list[class]);
+
+	/* queueing time for the latency statistics */
+	rq->elevator_private[0] = (void *)(unsigned long)
+		ktime_to_us(ktime_get());
+}
+
+/*
+ * remove rq from rbtree and fifo.
+ */
+static void flash_remove_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	rq_fifo_clear(rq);
+	flash_del_rq_rb(fd, rq);
+}
+
+static int
+flash_merge(struct request_queue *q, struct request **req, struct bio *bio)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	struct request *__rq;
+
+	/*
+	 * check for front merge
+	 */
+	if (fd->front_merges) {
+		sector_t sector = bio->bi_sector + bio_sectors(bio);
+
+		__rq = elv_rb_find(&fd->sort_list[flash_bio_class(bio)], sector);
+		if (__rq) {
+			BUG_ON(sector != blk_rq_pos(__rq));
+
+			if (elv_rq_merge_ok(__rq, bio)) {
+				*req = __rq;
+				return ELEVATOR_FRONT_MERGE;
+			}
+		}
+	}
+
+	return ELEVATOR_NO_MERGE;
+}
+
+static void flash_merged_request(struct request_queue *q,
+				 struct request *req, int type)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	/*
+	 * if the merge was a front merge, we need to reposition request
+	 */
+	if (type == ELEVATOR_FRONT_MERGE) {
+		elv_rb_del(flash_rb_root(fd, req), req);
+		flash_add_rq_rb(fd, req);
+	}
+}
+
+static void
+flash_merged_requests(struct request_queue *q, struct request *req,
+		      struct request *next)
+{
+	/*
+	 * keep the fifo position and the queueing time of the older one
+	 */
+	if (!list_empty(&req->queuelist) && !list_empty(&next->queuelist)) {
+		if ((long)((unsigned long)next->elevator_private[0] -
+			   (unsigned long)req->elevator_private[0]) < 0) {
+			list_move(&req->queuelist, &next->queuelist);
+			req->elevator_private[0] = next->elevator_private[0];
+		}
+	}
+
+	flash_remove_request(q, next);
+}
+
+static void
+flash_move_to_dispatch(struct flash_data *fd, struct request *rq)
+{
+	flash_remove_request(rq->q, rq);
+	elv_dispatch_add_tail(rq->q, rq);
+}
+
+/*
+ * Pick the next async request.  A batch starts at the first queued
+ * request of the erase block holding the oldest async write and goes up
+ * in sector order while it stays in that block or continues sequentially
+ * into the next one.
+ */
+static struct request *flash_next_async(struct flash_data *fd)
+{
+	struct request *rq = fd->next_async, *prev;
+	sector_t block;
+
+	if (rq && fd->batching < fd->async_batch) {
+		if (blk_rq_pos(rq) == fd->last_sector) {
+			fd->batch_block = flash_erase_block(fd, blk_rq_pos(rq));
+			return rq;
+		}
+		if (flash_erase_block(fd, blk_rq_pos(rq)) == fd->batch_block)
+			return rq;
+	}
+
+	rq = rq_entry_fifo(fd->fifo_list[BLK_RW_ASYNC].next);
+	block = flash_erase_block(fd, blk_rq_pos(rq));
+	while ((prev = flash_former_request(rq)) &&
+	       flash_erase_block(fd, blk_rq_pos(prev)) == block)
+		rq = prev;
+
+	fd->batch_block = block;
+	fd->batching = 0;
+	return rq;
+}
+
+static int flash_dispatch_requests(struct request_queue *q, int force)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int sync = !list_empty(&fd->fifo_list[BLK_RW_SYNC]);
+	const int async = !list_empty(&fd->fifo_list[BLK_RW_ASYNC]);
+	struct request *rq;
+
+	if (!sync && !async)
+		return 0;
+
+	/*
+	 * stay in the current class while it has work and either the
+	 * other class is idle or the slice has time left
+	 */
+	if (fd->cur_class == BLK_RW_SYNC) {
+		if (!sync || (async && time_after(jiffies, fd->slice_end)))
+			flash_start_slice(fd, BLK_RW_ASYNC);
+	} else {
+		if (!async || (sync && time_after(jiffies, fd->slice_end)))
+			flash_start_slice(fd, BLK_RW_SYNC);
+	}
+
+	if (fd->cur_class == BLK_RW_SYNC) {
+		rq = rq_entry_fifo(fd->fifo_list[BLK_RW_SYNC].next);
+	} else {
+		rq = flash_next_async(fd);
+		fd->batching++;
+		fd->next_async = flash_latter_request(rq);
+		fd->last_sector = rq_end_sector(rq);
+	}
+
+	flash_move_to_dispatch(fd, rq);
+
+	return 1;
+}
+
+static void flash_completed_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	struct flash_stats *st = &fd->stats[rq_is_sync(rq)];
+	unsigned long lat;
+
+	lat = (unsigned long)ktime_to_us(ktime_get()) -
+		(unsigned long)rq->elevator_private[0];
+
+	st->completed++;
+	st->total_us += lat;
+	if (lat > st->max_us)
+		st->max_us = lat;
+}
+
+static void flash_exit_queue(struct elevator_queue *e)
+{
+	struct flash_data *fd = e->elevator_data;
+
+	BUG_ON(!list_empty(&fd->fifo_list[BLK_RW_SYNC]));
+	BUG_ON(!list_empty(&fd->fifo_list[BLK_RW_ASYNC]));
+
+	kfree(fd);
+}
+
+/*
+ * initialize elevator private data (flash_data).
+ */
+static void *flash_init_queue(struct request_queue *q)
+{
+	struct flash_data *fd;
+
+	fd = kmalloc_node(sizeof(*fd), GFP_KERNEL | __GFP_ZERO, q->node);
+	if (!fd)
+		return NULL;
+
+	fd->queue = q;
+	INIT_LIST_HEAD(&fd->fifo_list[BLK_RW_SYNC]);
+	INIT_LIST_HEAD(&fd->fifo_list[BLK_RW_ASYNC]);
+	fd->sort_list[BLK_RW_SYNC] = RB_ROOT;
+	fd->sort_list[BLK_RW_ASYNC] = RB_ROOT;
+	fd->slice[BLK_RW_SYNC] = sync_slice;
+	fd->slice[BLK_RW_ASYNC] = async_slice;
+	fd->async_batch = async_batch;
+	fd->erase_block_kb = erase_block_kb;
+	fd->front_merges = 1;
+	fd->cur_class = BLK_RW_SYNC;
+	return fd;
+}
+
+/*
+ * sysfs parts below
+ */
+
+static ssize_t
+flash_var_show(int var, char *page)
+{
+	return sprintf(page, "%d\n", var);
+}
+
+static ssize_t
+flash_var_store(int *var, const char *page, size_t count)
+{
+	char *p = (char *) page;
+
+	*var = simple_strtol(p, &p, 10);
+	return count;
+}
+
+#define SHOW_FUNCTION(__FUNC, __VAR, __CONV)				\
+static ssize_t __FUNC(struct elevator_queue *e, char *page)		\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data = __VAR;						\
+	if (__CONV)							\
+		__data = jiffies_to_msecs(__data);			\
+	return flash_var_show(__data, (page));				\
+}
+SHOW_FUNCTION(flash_sync_slice_show, fd->slice[BLK_RW_SYNC], 1);
+SHOW_FUNCTION(flash_async_slice_show, fd->slice[BLK_RW_ASYNC], 1);
+SHOW_FUNCTION(flash_async_batch_show, fd->async_batch, 0);
+SHOW_FUNCTION(flash_erase_block_kb_show, fd->erase_block_kb, 0);
+SHOW_FUNCTION(flash_front_merges_show, fd->front_merges, 0);
+#undef SHOW_FUNCTION
+
+#define STORE_FUNCTION(__FUNC, __PTR, MIN, MAX, __CONV)			\
+static ssize_t __FUNC(struct elevator_queue *e, const char *page, size_t count)	\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data;							\
+	int ret = flash_var_store(&__data, (page), count);		\
+	if (__data < (MIN))						\
+		__data = (MIN);						\
+	else if (__data > (MAX))					\
+		__data = (MAX);						\
+	if (__CONV)							\
+		*(__PTR) = msecs_to_jiffies(__data);			\
+	else								\
+		*(__PTR) = __data;					\
+	return ret;							\
+}
+STORE_FUNCTION(flash_sync_slice_store, &fd->slice[BLK_RW_SYNC], 1, INT_MAX, 1);
+STORE_FUNCTION(flash_async_slice_store, &fd->slice[BLK_RW_ASYNC], 1, INT_MAX, 1);
+STORE_FUNCTION(flash_async_batch_store, &fd->async_batch, 1, INT_MAX, 0);
+STORE_FUNCTION(flash_erase_block_kb_store, &fd->erase_block_kb, 0, INT_MAX >> 1, 0);
+STORE_FUNCTION(flash_front_merges_store, &fd->front_merges, 0, 1, 0);
+#undef STORE_FUNCTION
+
+/*
+ * queue to completion latency: completed requests, average and max in usecs,
+ * any write resets the counters
+ */
+static ssize_t flash_latency_show(struct flash_data *fd, int class, char *page)
+{
+	struct flash_stats st;
+	u64 avg;
+
+	spin_lock_irq(fd->queue->queue_lock);
+	st = fd->stats[class];
+	spin_unlock_irq(fd->queue->queue_lock);
+
+	avg = st.total_us;
+	if (st.completed)
+		do_div(avg, st.completed);
+
+	return sprintf(page, "%lu %llu %lu\n", st.completed,
+		       (unsigned long long)avg, st.max_us);
+}
+
+static ssize_t flash_latency_store(struct flash_data *fd, int class,
+				   size_t count)
+{
+	spin_lock_irq(fd->queue->queue_lock);
+	memset(&fd->stats[class], 0, sizeof(fd->stats[class]));
+	spin_unlock_irq(fd->queue->queue_lock);
+
+	return count;
+}
+
+#define LATENCY_FUNCTIONS(__NAME, __CLASS)				\
+static ssize_t flash_##__NAME##_latency_show(struct elevator_queue *e,	\
+					     char *page)		\
+{									\
+	return flash_latency_show(e->elevator_data, __CLASS, page);	\
+}									\
+static ssize_t flash_##__NAME##_latency_store(struct elevator_queue *e,	\
+					      const char *page, size_t count) \
+{									\
+	return flash_latency_store(e->elevator_data, __CLASS, count);	\
+}
+LATENCY_FUNCTIONS(sync, BLK_RW_SYNC);
+LATENCY_FUNCTIONS(async, BLK_RW_ASYNC);
+#undef LATENCY_FUNCTIONS
+
+#define FD_ATTR(name) \
+	__ATTR(name, S_IRUGO|S_IWUSR, flash_##name##_show, \
+				      flash_##name##_store)
+
+static struct elv_fs_entry flash_attrs[] = {
+	FD_ATTR(sync_slice),
+	FD_ATTR(async_slice),
+	FD_ATTR(async_batch),
+	FD_ATTR(erase_block_kb),
+	FD_ATTR(front_merges),
+	FD_ATTR(sync_latency),
+	FD_ATTR(async_latency),
+	__ATTR_NULL
+};
+
+static struct elevator_type iosched_flash = {
+	.ops = {
+		.elevator_merge_fn = 		flash_merge,
+		.elevator_merged_fn =		flash_merged_request,
+		.elevator_merge_req_fn =	flash_merged_requests,
+		.elevator_dispatch_fn =		flash_dispatch_requests,
+		.elevator_add_req_fn =		flash_add_request,
+		.elevator_completed_req_fn =	flash_completed_request,
+		.elevator_former_req_fn =	elv_rb_former_request,
+		.elevator_latter_req_fn =	elv_rb_latter_request,
+		.elevator_init_fn =		flash_init_queue,
+		.elevator_exit_fn =		flash_exit_queue,
+	},
+
+	.elevator_attrs = flash_attrs,
+	.elevator_name = "flash",
+	.elevator_owner = THIS_MODULE,
+};
+
+static int __init flash_init(void)
+{
+	elv_register(&iosched_flash);
+
+	return 0;
+}
+
+static void __exit flash_exit(void)
+{
+	elv_unregister(&iosched_flash);
+}
+
+module_init(flash_init);
+module_exit(flash_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("flash IO scheduler");
@@ -48,6 +48,12 @@ struct driver_private {
 	struct klist_node knode_bus;
 	struct module_kobject *mkobj;
 	struct device_driver *driver;
+	atomic_t async_pending;
+	wait_queue_head_t async_wait;
+	struct list_head probe_stats;
+	unsigned int probe_calls;
+	u64 probe_ns;
+	u64 probe_max_ns;
 };
 #define to_driver(obj) container_of(obj, struct driver_private, kobj)
 
@@ -60,6 +66,7 @@ struct driver_private {
  * @knode_bus - node in bus list
  * @driver_data - private pointer for driver specific info.  Will turn into a
  * list soon.
+ * @async_driver - driver whose asynchronous probe of this device is pending.
  * @device - pointer back to the struct class that this structure is
  * associated with.
  *
@@ -71,6 +78,7 @@ struct device_private {
 	struct klist_node knode_driver;
 	struct klist_node knode_bus;
 	void *driver_data;
+	struct device_driver *async_driver;
 	struct device *device;
 };
 #define to_device_private_parent(obj)	\
@@ -104,6 +112,7 @@ extern int bus_add_driver(struct device_driver *drv);
 extern void bus_remove_driver(struct device_driver *drv);
 
 extern void driver_detach(struct device_driver *drv);
+extern void driver_probe_stats_remove(struct device_driver *drv);
 extern int driver_probe_device(struct device_driver *drv, struct device *dev);
 static inline int driver_match_device(struct device_driver *drv,
 				      struct device *dev)
@@ -640,6 +640,8 @@ int bus_add_driver(struct device_driver *drv)
 		goto out_put_bus;
 	}
 	klist_init(&priv->klist_devices, NULL, NULL);
+	init_waitqueue_head(&priv->async_wait);
+	INIT_LIST_HEAD(&priv->probe_stats);
 	priv->driver = drv;
 	drv->p = priv;
 	priv->kobj.kset = bus->p->drivers_kset;
@@ -708,7 +710,9 @@ void bus_remove_driver(struct device_driver *drv)
 	driver_remove_file(drv, &driver_attr_uevent);
 	klist_remove(&drv->p->knode_bus);
 	pr_debug("bus: '%s': remove driver %s\n", drv->bus->name, drv->name);
+	wait_for_driver_probe(drv);
 	driver_detach(drv);
+	driver_probe_stats_remove(drv);
 	module_remove_driver(drv);
 	kobject_put(&drv->p->kobj);
 	bus_put(drv->bus);
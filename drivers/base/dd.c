@@ -24,6 +24,9 @@
 #include <linux/wait.h>
 #include <linux/async.h>
 #include <linux/pm_runtime.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/hrtimer.h>
 
 #include "base.h"
 #include "power/power.h"
@@ -105,15 +108,51 @@ EXPORT_SYMBOL_GPL(device_bind_driver);
 static atomic_t probe_count = ATOMIC_INIT(0);
 static DECLARE_WAIT_QUEUE_HEAD(probe_waitqueue);
 
+/*
+ * Drivers that have probed at least one device, with the number of probes
+ * and the time they took.  Shown in debugfs as "probe_times".
+ */
+static LIST_HEAD(probe_stats_list);
+static DEFINE_MUTEX(probe_stats_mutex);
+
+static void driver_probe_account(struct device_driver *drv, s64 ns)
+{
+	struct driver_private *priv = drv->p;
+
+	mutex_lock(&probe_stats_mutex);
+	if (list_empty(&priv->probe_stats))
+		list_add_tail(&priv->probe_stats, &probe_stats_list);
+	priv->probe_calls++;
+	priv->probe_ns += ns;
+	if (priv->probe_max_ns < ns)
+		priv->probe_max_ns = ns;
+	mutex_unlock(&probe_stats_mutex);
+}
+
+void driver_probe_stats_remove(struct device_driver *drv)
+{
+	mutex_lock(&probe_stats_mutex);
+	list_del_init(&drv->p->probe_stats);
+	mutex_unlock(&probe_stats_mutex);
+}
+
 static int really_probe(struct device *dev, struct device_driver *drv)
 {
+	ktime_t calltime;
+	s64 duration;
 	int ret = 0;
+	int probe_ret = 0;
 
 	atomic_inc(&probe_count);
 	pr_debug("bus: '%s': %s: probing driver %s with device %s\n",
 		 drv->bus->name, __func__, drv->name, dev_name(dev));
 	WARN_ON(!list_empty(&dev->devres_head));
 
+	if (initcall_debug)
+		printk(KERN_DEBUG "probing  %s with %s @ %i\n",
+		       dev_name(dev), drv->name, task_pid_nr(current));
+	calltime = ktime_get();
+
 	dev->driver = drv;
 	if (driver_sysfs_add(dev)) {
 		printk(KERN_ERR "%s: driver_sysfs_add(%s) failed\n",
@@ -138,6 +177,7 @@ static int really_probe(struct device *dev, struct device_driver *drv)
 	goto done;
 
 probe_failed:
+	probe_ret = ret;
 	devres_release_all(dev);
 	driver_sysfs_remove(dev);
 	dev->driver = NULL;
@@ -154,6 +194,13 @@ probe_failed:
 	 */
 	ret = 0;
 done:
+	duration = ktime_to_ns(ktime_sub(ktime_get(), calltime));
+	driver_probe_account(drv, duration);
+	if (initcall_debug)
+		printk(KERN_DEBUG "probe of %s with %s returned %d after %lld usecs\n",
+		       dev_name(dev), drv->name, probe_ret,
+		       (long long)duration >> 10);
+
 	atomic_dec(&probe_count);
 	wake_up(&probe_waitqueue);
 	return ret;
@@ -186,6 +233,185 @@ void wait_for_device_probe(void)
 }
 EXPORT_SYMBOL_GPL(wait_for_device_probe);
 
+/**
+ * wait_for_driver_probe
+ * @drv: driver
+ *
+ * Wait for the asynchronous probes scheduled for @drv to be completed.
+ */
+void wait_for_driver_probe(struct device_driver *drv)
+{
+	wait_event(drv->p->async_wait, !atomic_read(&drv->p->async_pending));
+}
+EXPORT_SYMBOL_GPL(wait_for_driver_probe);
+
+/* Wait for the drivers listed in @drv->probe_after to finish probing. */
+static void driver_wait_for_deps(struct device_driver *drv)
+{
+	const char * const *name;
+	struct device_driver *dep;
+
+	for (name = drv->probe_after; name && *name; name++) {
+		dep = driver_find(*name, drv->bus);
+		if (dep) {
+			wait_for_driver_probe(dep);
+			put_driver(dep);
+		}
+	}
+}
+
+#ifdef CONFIG_ASYNC_DEVICE_PROBE
+static char async_probe_drivers[128];
+static bool async_probe_cmdline;
+
+/*
+ * driver_async_probe=drv1,drv2,...
+ * Probe the listed drivers asynchronously during boot, in addition to those
+ * that set async_probe themselves.  Overrides the board's default list.
+ */
+static int __init async_probe_setup(char *str)
+{
+	strlcpy(async_probe_drivers, str, sizeof(async_probe_drivers));
+	async_probe_cmdline = true;
+	return 1;
+}
+__setup("driver_async_probe=", async_probe_setup);
+
+/**
+ * driver_async_probe_default - set the drivers to probe asynchronously
+ * @drivers: comma separated list of driver names
+ *
+ * Called by board code to select drivers whose probes are slow but don't
+ * need to be finished before the rest of the boot continues.  Ignored if
+ * the list was given on the command line.
+ */
+void __init driver_async_probe_default(const char *drivers)
+{
+	if (!async_probe_cmdline)
+		strlcpy(async_probe_drivers, drivers,
+			sizeof(async_probe_drivers));
+}
+
+static bool driver_listed_async(const char *name)
+{
+	const char *p = async_probe_drivers;
+	size_t len = strlen(name);
+
+	while (*p) {
+		if (!strncmp(p, name, len) && (p[len] == ',' || !p[len]))
+			return true;
+		p = strchr(p, ',');
+		if (!p)
+			break;
+		p++;
+	}
+	return false;
+}
+
+/*
+ * Only probes of devices that exist while booting are run asynchronously.
+ * Afterwards, callers such as module loading and hotplug expect the device
+ * to be bound when registration returns.
+ */
+static bool driver_wants_async_probing(struct device_driver *drv)
+{
+	return drv->async_probe || driver_listed_async(drv->name);
+}
+
+static bool driver_allows_async_probing(struct device_driver *drv)
+{
+	return system_state == SYSTEM_BOOTING &&
+	       driver_wants_async_probing(drv);
+}
+#else
+static inline bool driver_wants_async_probing(struct device_driver *drv)
+{
+	return false;
+}
+
+static inline bool driver_allows_async_probing(struct device_driver *drv)
+{
+	return false;
+}
+#endif
+
+static int __device_attach(struct device_driver *drv, void *data);
+
+struct device_attach_after {
+	struct device		*dev;
+	struct device_driver	*drv;
+	bool			seen;
+};
+
+/*
+ * Walk from the start rather than from @drv: @drv may be unregistered
+ * (platform_driver_probe()) as soon as its probes are accounted for.
+ */
+static int __device_attach_after(struct device_driver *drv, void *data)
+{
+	struct device_attach_after *after = data;
+
+	if (!after->seen) {
+		after->seen = drv == after->drv;
+		return 0;
+	}
+	return __device_attach(drv, after->dev);
+}
+
+static void driver_probe_device_async_fn(void *data, async_cookie_t cookie)
+{
+	struct device *dev = data;
+	struct device_driver *drv = dev->p->async_driver;
+	/*
+	 * The parent is locked only when it is on the same bus (USB
+	 * interfaces, I2C adapters); otherwise all platform devices would
+	 * serialize on the platform bus device.
+	 */
+	struct device *parent = dev->parent && dev->parent->bus == dev->bus ?
+				dev->parent : NULL;
+
+	driver_wait_for_deps(drv);
+
+	if (parent)
+		device_lock(parent);
+	device_lock(dev);
+	if (!dev->driver)
+		driver_probe_device(drv, dev);
+	dev->p->async_driver = NULL;
+	if (atomic_dec_and_test(&drv->p->async_pending))
+		wake_up(&drv->p->async_wait);
+	/*
+	 * __device_attach() stopped at @drv when it queued this probe; if
+	 * @drv did not take the device, give the drivers after it a chance.
+	 * Done after the wake up above, they may be waiting for @drv.
+	 */
+	if (!dev->driver && device_is_registered(dev)) {
+		struct device_attach_after after = { .dev = dev, .drv = drv };
+
+		pm_runtime_get_noresume(dev);
+		bus_for_each_drv(dev->bus, NULL, &after, __device_attach_after);
+		pm_runtime_put_sync(dev);
+	}
+	device_unlock(dev);
+	if (parent)
+		device_unlock(parent);
+
+	put_device(dev);
+}
+
+/*
+ * Schedule an asynchronous probe of @dev with @drv.  Must be called with
+ * @dev locked; @dev must not have another asynchronous probe pending.
+ */
+static void driver_probe_device_async(struct device_driver *drv,
+				      struct device *dev)
+{
+	get_device(dev);
+	dev->p->async_driver = drv;
+	atomic_inc(&drv->p->async_pending);
+	async_schedule(driver_probe_device_async_fn, dev);
+}
+
 /**
  * driver_probe_device - attempt to bind device & driver together
  * @drv: driver to bind a device to
@@ -222,6 +448,13 @@ static int __device_attach(struct device_driver *drv, void *data)
 	if (!driver_match_device(drv, dev))
 		return 0;
 
+	if (driver_allows_async_probing(drv)) {
+		if (!dev->p->async_driver)
+			driver_probe_device_async(drv, dev);
+		return 1;
+	}
+
+	driver_wait_for_deps(drv);
 	return driver_probe_device(drv, dev);
 }
 
@@ -287,8 +520,12 @@ static int __driver_attach(struct device *dev, void *data)
 	if (dev->parent)	/* Needed for USB */
 		device_lock(dev->parent);
 	device_lock(dev);
-	if (!dev->driver)
-		driver_probe_device(drv, dev);
+	if (!dev->driver && !dev->p->async_driver) {
+		if (driver_allows_async_probing(drv))
+			driver_probe_device_async(drv, dev);
+		else
+			driver_probe_device(drv, dev);
+	}
 	device_unlock(dev);
 	if (dev->parent)
 		device_unlock(dev->parent);
@@ -307,6 +544,8 @@ static int __driver_attach(struct device *dev, void *data)
  */
 int driver_attach(struct device_driver *drv)
 {
+	if (!driver_allows_async_probing(drv))
+		driver_wait_for_deps(drv);
 	return bus_for_each_dev(drv->bus, NULL, drv, __driver_attach);
 }
 EXPORT_SYMBOL_GPL(driver_attach);
@@ -426,3 +665,46 @@ int dev_set_drvdata(struct device *dev, void *data)
 	return 0;
 }
 EXPORT_SYMBOL(dev_set_drvdata);
+
+#ifdef CONFIG_DEBUG_FS
+static int probe_times_show(struct seq_file *s, void *unused)
+{
+	struct driver_private *priv;
+
+	seq_printf(s, "%-8s %-24s %6s %10s %10s %5s\n", "bus", "driver",
+		   "probes", "total_us", "max_us", "async");
+
+	mutex_lock(&probe_stats_mutex);
+	list_for_each_entry(priv, &probe_stats_list, probe_stats) {
+		struct device_driver *drv = priv->driver;
+
+		seq_printf(s, "%-8s %-24s %6u %10llu %10llu %5d\n",
+			   drv->bus->name, drv->name, priv->probe_calls,
+			   div_u64(priv->probe_ns, NSEC_PER_USEC),
+			   div_u64(priv->probe_max_ns, NSEC_PER_USEC),
+			   driver_wants_async_probing(drv));
+	}
+	mutex_unlock(&probe_stats_mutex);
+	return 0;
+}
+
+static int probe_times_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, probe_times_show, NULL);
+}
+
+static const struct file_operations probe_times_fops = {
+	.open		= probe_times_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init probe_times_debugfs_init(void)
+{
+	debugfs_create_file("probe_times", S_IRUGO, NULL, NULL,
+			    &probe_times_fops);
+	return 0;
+}
+late_initcall(probe_times_debugfs_init);
+#endif
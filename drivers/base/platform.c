@@ -486,6 +486,8 @@ int __init_or_module platform_driver_probe(struct platform_driver *drv,
 	/* temporary section violation during probe() */
 	drv->probe = probe;
 	retval = code = platform_driver_register(drv);
+	if (code == 0)
+		wait_for_driver_probe(&drv->driver);
 
 	/*
 	 * Fixup that section violation, being paranoid about code scanning
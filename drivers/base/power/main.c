@@ -179,6 +179,13 @@ static void initcall_debug_report(struct device *dev, ktime_t calltime,
 			error, (unsigned long long)ktime_to_ns(delta) >> 10);
 	}
 }
+
+static bool is_async(struct device *dev)
+{
+	return dev->power.async_suspend && pm_async_enabled
+		&& !pm_trace_is_enabled();
+}
+
 #ifdef CONFIG_SUSPEND_DEVICE_TIME_DEBUG
 static void suspend_time_debug_start(ktime_t *start)
 {
@@ -192,9 +199,6 @@ static void suspend_time_debug_report(const char *name, struct device *dev,
 	s64 usecs64;
 	int usecs;
 
-	if (!dev->driver)
-		return;
-
 	rettime = ktime_get();
 	usecs64 = ktime_to_us(ktime_sub(rettime, starttime));
 	usecs = usecs64;
@@ -203,8 +207,11 @@ static void suspend_time_debug_report(const char *name, struct device *dev,
 
 	if (device_suspend_time_threshold
 	    && usecs > device_suspend_time_threshold)
-		pr_info("PM: device %s:%s %s too slow, it takes \t %ld.%03ld msecs\n",
-			dev->bus->name, dev_name(dev), name,
+		pr_info("PM: device %s:%s (%s%s) %s too slow, it takes \t %ld.%03ld msecs\n",
+			dev->bus ? dev->bus->name :
+			(dev->class ? dev->class->name : ""),
+			dev_name(dev), dev_driver_string(dev),
+			is_async(dev) ? ", async" : "", name,
 			usecs / USEC_PER_MSEC, usecs % USEC_PER_MSEC);
 }
 #else
@@ -614,12 +621,6 @@ static void async_resume(void *data, async_cookie_t cookie)
 	put_device(dev);
 }
 
-static bool is_async(struct device *dev)
-{
-	return dev->power.async_suspend && pm_async_enabled
-		&& !pm_trace_is_enabled();
-}
-
 /**
  * dpm_resume - Execute "resume" callbacks for non-sysdev devices.
  * @state: PM transition of the system being carried out.
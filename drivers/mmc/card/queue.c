@@ -12,6 +12,7 @@
 #include <linux/slab.h>
 #include <linux/module.h>
 #include <linux/blkdev.h>
+#include <linux/elevator.h>
 #include <linux/freezer.h>
 #include <linux/kthread.h>
 #include <linux/scatterlist.h>
@@ -181,6 +182,16 @@ int mmc_init_queue(struct mmc_queue *mq, struct mmc_card *card,
 	if (mmc_can_erase(card))
 		mmc_queue_setup_discard(mq->queue, card);
 
+#ifdef CONFIG_IOSCHED_FLASH
+	/*
+	 * The default elevator is chosen for the SATA and USB disks; cards
+	 * get the flash one, which sizes its write batches from the erase
+	 * size set up above.  The queue is not in use yet, so this cannot
+	 * fail other than for memory, and then the default stays.
+	 */
+	elevator_change(mq->queue, "flash");
+#endif
+
 #ifdef CONFIG_MMC_BLOCK_BOUNCE
 	if (host->max_segs == 1) {
 		unsigned int bouncesz;
@@ -814,6 +814,12 @@ static int esdhc_pltfm_init(struct sdhci_host *host, struct sdhci_pltfm_data *pd
 	}
 	pltfm_host->priv = imx_data;
 
+	/*
+	 * The card re-init on resume only depends on this host and its own
+	 * regulators, let it run in parallel with the other controllers.
+	 */
+	device_enable_async_suspend(mmc_dev(host->mmc));
+
 	host->quirks |= SDHCI_QUIRK_BROKEN_TIMEOUT_VAL;
 
 	if (cpu_is_mx25() || cpu_is_mx35())
@@ -34,6 +34,7 @@
 #include <linux/list.h>
 #include <linux/module.h>
 #include <linux/platform_device.h>
+#include <linux/pm_qos_params.h>
 
 #include <mach/clock.h>
 #include <mach/hardware.h>
@@ -44,6 +45,10 @@
 
 #define DRV_NAME			"flexcan"
 
+/* depth of the RX FIFO and length of the shortest frame on the wire */
+#define FLEXCAN_RX_FIFO_DEPTH		6
+#define FLEXCAN_MIN_FRAME_BITS		47
+
 /* 8 for RX fifo and 2 error handling */
 #define FLEXCAN_NAPI_WEIGHT		(8 + 2)
 
@@ -197,6 +202,7 @@ struct flexcan_priv {
 	struct flexcan_platform_data *pdata;
 	enum flexcan_ip_version version;
 	int id;
+	struct pm_qos_request_list pm_qos_req;
 };
 
 static struct can_bittiming_const flexcan_bittiming_const = {
@@ -840,6 +846,11 @@ static int flexcan_open(struct net_device *dev)
 	if (err)
 		goto out;
 
+	/* back-to-back frames must not overrun the RX FIFO */
+	pm_qos_add_request(&priv->pm_qos_req, PM_QOS_CPU_DMA_LATENCY,
+			   FLEXCAN_RX_FIFO_DEPTH * FLEXCAN_MIN_FRAME_BITS *
+			   USEC_PER_SEC / priv->can.bittiming.bitrate);
+
 	err = request_irq(dev->irq, flexcan_irq, IRQF_SHARED, dev->name, dev);
 	if (err)
 		goto out_close;
@@ -854,6 +865,7 @@ static int flexcan_open(struct net_device *dev)
 	return 0;
 
  out_close:
+	pm_qos_remove_request(&priv->pm_qos_req);
 	close_candev(dev);
  out:
 	clk_disable(priv->clk);
@@ -871,6 +883,7 @@ static int flexcan_close(struct net_device *dev)
 
 	free_irq(dev->irq, dev);
 	clk_disable(priv->clk);
+	pm_qos_remove_request(&priv->pm_qos_req);
 
 	close_candev(dev);
 
@@ -37,6 +37,8 @@
 #include <linux/netdevice.h>
 #include <linux/etherdevice.h>
 #include <linux/skbuff.h>
+#include <linux/jhash.h>
+#include <linux/random.h>
 #include <linux/spinlock.h>
 #include <linux/workqueue.h>
 #include <linux/bitops.h>
@@ -47,8 +49,11 @@
 #include <linux/platform_device.h>
 #include <linux/phy.h>
 #include <linux/fec.h>
+#include <linux/pm_qos_params.h>
+#include <net/ip.h>
 
 #include <asm/cacheflush.h>
+#include <asm/unaligned.h>
 
 #ifndef CONFIG_ARM
 #include <asm/coldfire.h>
@@ -72,11 +77,16 @@
 #define FEC_QUIRK_SWAP_FRAME		(1 << 1)
 /* ENET IP errata ticket TKT168103 */
 #define FEC_QUIRK_BUG_TKT168103		(1 << 2)
+/* Controller can shift received frames by two bytes */
+#define FEC_QUIRK_HAS_RACC		(1 << 3)
+
+#define FEC_RACC_SHIFT16		(1 << 7)
 
 static struct platform_device_id fec_devtype[] = {
 	{
 		.name = "enet",
-		.driver_data = FEC_QUIRK_ENET_MAC | FEC_QUIRK_BUG_TKT168103,
+		.driver_data = FEC_QUIRK_ENET_MAC | FEC_QUIRK_BUG_TKT168103 |
+				FEC_QUIRK_HAS_RACC,
 	},
 	{
 		.name = "fec",
@@ -94,6 +104,11 @@ static unsigned char macaddr[ETH_ALEN];
 module_param_array(macaddr, byte, NULL, 0);
 MODULE_PARM_DESC(macaddr, "FEC Ethernet MAC address");
 
+static int rx_copybreak = 256;
+module_param(rx_copybreak, int, 0644);
+MODULE_PARM_DESC(rx_copybreak,
+	"Frames longer than this are passed up without a copy (ENET only)");
+
 #if defined(CONFIG_M5272)
 /*
  * Some hardware gets it MAC address out of local flash memory.
@@ -168,6 +183,13 @@ MODULE_PARM_DESC(macaddr, "FEC Ethernet MAC address");
 #define FEC_ENET_RAFL_V		0x8
 #define FEC_ENET_OPD_V		0xFFF0
 
+/* Receive control register bits for the internal MAC loopback */
+#define FEC_RCR_LOOP		(1 << 0)
+#define FEC_RCR_DRT		(1 << 1)
+#define FEC_RCR_RGMII_EN	(1 << 6)
+#define FEC_RCR_RMII_MODE	(1 << 8)
+#define FEC_RCR_RMII_10T	(1 << 9)
+
 /*
  * The 5270/5271/5280/5282/532x RX control register also contains maximum frame
  * size bits. Other FEC hardware does not, so we need to take that into
@@ -201,8 +223,6 @@ struct fec_enet_private {
 	unsigned char *tx_bounce[TX_RING_SIZE];
 	struct	sk_buff* tx_skbuff[TX_RING_SIZE];
 	struct	sk_buff* rx_skbuff[RX_RING_SIZE];
-	ushort	skb_cur;
-	ushort	skb_dirty;
 
 	/* CPM dual port RAM relative addresses */
 	dma_addr_t	bd_dma;
@@ -231,6 +251,9 @@ struct fec_enet_private {
 	int	index;
 	int	link;
 	int	full_duplex;
+	int	mac_loopback;
+	struct	pm_qos_request_list pm_qos_lat;
+	struct	pm_qos_request_list pm_qos_bw;
 	struct	completion mdio_done;
 	struct delayed_work fixup_trigger_tx;
 
@@ -240,6 +263,9 @@ struct fec_enet_private {
 	struct napi_struct napi;
 	int	napi_weight;
 	bool	use_napi;
+
+	/* seed of the RPS flow hash computed on receive */
+	u32	rx_hash_rnd;
 };
 
 #define FEC_NAPI_WEIGHT 64
@@ -313,17 +339,113 @@ static void fixup_trigger_tx_func(struct work_struct *work)
 	writel(0, fep->hwp + FEC_X_DES_ACTIVE);
 }
 
+/*
+ * Number of free transmit buffer descriptors.  cur_tx and dirty_tx are
+ * equal when the ring is either empty or full, tx_full tells which.
+ */
+static inline int fec_enet_tx_free_bds(struct fec_enet_private *fep)
+{
+	if (fep->tx_full)
+		return 0;
+
+	return TX_RING_SIZE -
+		((fep->cur_tx - fep->dirty_tx) & TX_RING_MOD_MASK);
+}
+
+static inline struct bufdesc *
+fec_enet_next_txbd(struct fec_enet_private *fep, struct bufdesc *bdp)
+{
+	return (bdp->cbd_sc & BD_ENET_TX_WRAP) ? fep->tx_bd_base : bdp + 1;
+}
+
+/*
+ * Point a transmit buffer descriptor at a buffer of the frame.  On some
+ * FEC implementations data must be aligned on 4-byte boundaries; such
+ * buffers are copied to the bounce buffer of the descriptor.  Frames
+ * handed to us are no longer than the MTU, so neither is a fragment.
+ */
+static void fec_enet_txbd_map(struct fec_enet_private *fep,
+		struct bufdesc *bdp, void *bufaddr, unsigned int len)
+{
+	const struct platform_device_id *id_entry =
+				platform_get_device_id(fep->pdev);
+
+	if (((unsigned long) bufaddr) & FEC_ALIGNMENT) {
+		unsigned int index;
+		void *bounce;
+		index = bdp - fep->tx_bd_base;
+		bounce = PTR_ALIGN(fep->tx_bounce[index], FEC_ALIGNMENT + 1);
+		memcpy(bounce, bufaddr, len);
+		bufaddr = bounce;
+	}
+
+	/*
+	 * Some design made an incorrect assumption on endian mode of
+	 * the system that it's running on. As the result, driver has to
+	 * swap every frame going to and coming from the controller.
+	 */
+	if (id_entry->driver_data & FEC_QUIRK_SWAP_FRAME)
+		swap_buffer(bufaddr, len);
+
+	bdp->cbd_datlen = len;
+
+	/* Push the data cache so the CPM does not get stale memory
+	 * data.
+	 */
+	bdp->cbd_bufaddr = dma_map_single(&fep->pdev->dev, bufaddr,
+			len, DMA_TO_DEVICE);
+}
+
+/*
+ * Timestamping and the completion interrupt are only requested on the
+ * last descriptor of a frame, which is the one fec_enet_tx() looks at.
+ */
+static unsigned short fec_enet_txbd_ptp(struct fec_enet_private *fep,
+		struct bufdesc *bdp, struct sk_buff *skb, bool last)
+{
+	unsigned short status = 0;
+	unsigned long estatus = 0;
+
+	if (!fep->ptimer_present)
+		return 0;
+
+	if (last) {
+		if (fec_ptp_do_txstamp(skb)) {
+			estatus = BD_ENET_TX_TS;
+			status = BD_ENET_TX_PTP;
+		}
+		estatus |= BD_ENET_TX_INT;
+	}
+#ifdef CONFIG_ENHANCED_BD
+	bdp->cbd_esc = estatus;
+	bdp->cbd_bdu = 0;
+#endif
+	return status;
+}
+
 static netdev_tx_t
 fec_enet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 {
 	struct fec_enet_private *fep = netdev_priv(ndev);
 	const struct platform_device_id *id_entry =
 				platform_get_device_id(fep->pdev);
-	struct bufdesc *bdp, *bdp_pre;
-	void *bufaddr;
+	struct bufdesc *bdp, *bdp_first, *bdp_pre;
 	unsigned short	status;
-	unsigned long   estatus;
 	unsigned long flags;
+	int nr_frags, i;
+
+	/*
+	 * NETIF_F_HW_CSUM only comes with scatter-gather, the controller
+	 * can't insert checksums with the buffer descriptors in use.
+	 */
+	if (skb->ip_summed == CHECKSUM_PARTIAL && skb_checksum_help(skb))
+		goto drop;
+
+	/* The 1588 code parses the headers of the frame in place */
+	if (fep->ptimer_present && skb_linearize(skb))
+		goto drop;
+
+	nr_frags = skb_shinfo(skb)->nr_frags;
 
 	spin_lock_irqsave(&fep->hw_lock, flags);
 	if (!fep->link) {
@@ -333,11 +455,7 @@ fec_enet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 		return NETDEV_TX_BUSY;
 	}
 
-	/* Fill in a Tx ring entry */
-	bdp = fep->cur_tx;
-	status = bdp->cbd_sc;
-
-	if (status & BD_ENET_TX_READY) {
+	if (fec_enet_tx_free_bds(fep) < nr_frags + 1) {
 		/* Ooops.  All transmit buffers are full.  Bail out.
 		 * This should not happen, since ndev->tbusy should be set.
 		 */
@@ -347,62 +465,46 @@ fec_enet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 		return NETDEV_TX_BUSY;
 	}
 
-	/* Clear all of the status flags */
-	status &= ~BD_ENET_TX_STATS;
-
-	/* Set buffer length and buffer pointer */
-	bufaddr = skb->data;
-	bdp->cbd_datlen = skb->len;
-
 	/*
-	 * On some FEC implementations data must be aligned on
-	 * 4-byte boundaries. Use bounce buffers to copy data
-	 * and get it aligned. Ugh.
+	 * Fill in the descriptors of the fragments before the first one,
+	 * so the controller doesn't start on a partial frame.  Fragments
+	 * are sent in place: they may be pages of a packet mmap ring.
 	 */
-	if (((unsigned long) bufaddr) & FEC_ALIGNMENT) {
-		unsigned int index;
-		index = bdp - fep->tx_bd_base;
-		bufaddr = PTR_ALIGN(fep->tx_bounce[index], FEC_ALIGNMENT + 1);
-		memcpy(bufaddr, (void *)skb->data, skb->len);
+	bdp_first = bdp = fep->cur_tx;
+	for (i = 0; i < nr_frags; i++) {
+		skb_frag_t *frag = &skb_shinfo(skb)->frags[i];
+		bool last = (i == nr_frags - 1);
+
+		bdp = fec_enet_next_txbd(fep, bdp);
+		fec_enet_txbd_map(fep, bdp,
+			page_address(frag->page) + frag->page_offset,
+			frag->size);
+
+		status = (bdp->cbd_sc & BD_ENET_TX_WRAP) |
+			 BD_ENET_TX_READY | BD_ENET_TX_TC;
+		status |= fec_enet_txbd_ptp(fep, bdp, skb, last);
+		if (last)
+			status |= BD_ENET_TX_INTR | BD_ENET_TX_LAST;
+		bdp->cbd_sc = status;
 	}
 
-	if (fep->ptimer_present) {
-		if (fec_ptp_do_txstamp(skb)) {
-			estatus = BD_ENET_TX_TS;
-			status |= BD_ENET_TX_PTP;
-		} else
-			estatus = 0;
-#ifdef CONFIG_ENHANCED_BD
-		bdp->cbd_esc = (estatus | BD_ENET_TX_INT);
-		bdp->cbd_bdu = 0;
-#endif
-	}
-	/*
-	 * Some design made an incorrect assumption on endian mode of
-	 * the system that it's running on. As the result, driver has to
-	 * swap every frame going to and coming from the controller.
-	 */
-	if (id_entry->driver_data & FEC_QUIRK_SWAP_FRAME)
-		swap_buffer(bufaddr, skb->len);
+	fec_enet_txbd_map(fep, bdp_first, skb->data, skb_headlen(skb));
+	status = (bdp_first->cbd_sc & BD_ENET_TX_WRAP) |
+		 BD_ENET_TX_READY | BD_ENET_TX_TC;
+	status |= fec_enet_txbd_ptp(fep, bdp_first, skb, !nr_frags);
+	if (!nr_frags)
+		status |= BD_ENET_TX_INTR | BD_ENET_TX_LAST;
 
-	/* Save skb pointer */
-	fep->tx_skbuff[fep->skb_cur] = skb;
+	/* Save skb pointer, it is freed with the last descriptor */
+	fep->tx_skbuff[bdp - fep->tx_bd_base] = skb;
 
 	ndev->stats.tx_bytes += skb->len;
-	fep->skb_cur = (fep->skb_cur+1) & TX_RING_MOD_MASK;
-
-	/* Push the data cache so the CPM does not get stale memory
-	 * data.
-	 */
-	bdp->cbd_bufaddr = dma_map_single(&fep->pdev->dev, bufaddr,
-			FEC_ENET_TX_FRSIZE, DMA_TO_DEVICE);
 
 	/* Send it on its way.  Tell FEC it's ready, interrupt when done,
 	 * it's the last BD of the frame, and to put the CRC on the end.
 	 */
-	status |= (BD_ENET_TX_READY | BD_ENET_TX_INTR
-			| BD_ENET_TX_LAST | BD_ENET_TX_TC);
-	bdp->cbd_sc = status;
+	wmb();
+	bdp_first->cbd_sc = status;
 
 	/* Trigger transmission start */
 	writel(0, fep->hwp + FEC_X_DES_ACTIVE);
@@ -414,10 +516,7 @@ fec_enet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 					 msecs_to_jiffies(1));
 
 	/* If this was the last BD in the ring, start at the beginning again. */
-	if (status & BD_ENET_TX_WRAP)
-		bdp = fep->tx_bd_base;
-	else
-		bdp++;
+	bdp = fec_enet_next_txbd(fep, bdp);
 
 	if (bdp == fep->dirty_tx) {
 		fep->tx_full = 1;
@@ -426,9 +525,18 @@ fec_enet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 
 	fep->cur_tx = bdp;
 
+	/* Keep room for a frame with the largest number of fragments */
+	if (fec_enet_tx_free_bds(fep) <= MAX_SKB_FRAGS)
+		netif_stop_queue(ndev);
+
 	spin_unlock_irqrestore(&fep->hw_lock, flags);
 
 	return NETDEV_TX_OK;
+
+drop:
+	ndev->stats.tx_dropped++;
+	dev_kfree_skb_any(skb);
+	return NETDEV_TX_OK;
 }
 
 static void
@@ -479,6 +587,7 @@ fec_enet_tx(struct net_device *ndev)
 	struct bufdesc *bdp;
 	unsigned short status;
 	struct	sk_buff	*skb;
+	int index;
 
 	fep = netdev_priv(ndev);
 	fpp = fep->ptp_priv;
@@ -491,12 +600,14 @@ fec_enet_tx(struct net_device *ndev)
 
 		if (bdp->cbd_bufaddr)
 			dma_unmap_single(&fep->pdev->dev, bdp->cbd_bufaddr,
-				FEC_ENET_TX_FRSIZE, DMA_TO_DEVICE);
+				bdp->cbd_datlen, DMA_TO_DEVICE);
 		bdp->cbd_bufaddr = 0;
 
-		skb = fep->tx_skbuff[fep->skb_dirty];
+		/* Only the last descriptor of a frame has the skb */
+		index = bdp - fep->tx_bd_base;
+		skb = fep->tx_skbuff[index];
 		if (!skb)
-			break;
+			goto next_bd;
 		/* Check for errors. */
 		if (status & (BD_ENET_TX_HB | BD_ENET_TX_LC |
 				   BD_ENET_TX_RL | BD_ENET_TX_UN |
@@ -539,9 +650,9 @@ fec_enet_tx(struct net_device *ndev)
 
 		/* Free the sk buffer associated with this last transmit */
 		dev_kfree_skb_any(skb);
-		fep->tx_skbuff[fep->skb_dirty] = NULL;
-		fep->skb_dirty = (fep->skb_dirty + 1) & TX_RING_MOD_MASK;
+		fep->tx_skbuff[index] = NULL;
 
+next_bd:
 		/* Update pointer to next buffer descriptor to be transmitted */
 		if (status & BD_ENET_TX_WRAP)
 			bdp = fep->tx_bd_base;
@@ -550,16 +661,115 @@ fec_enet_tx(struct net_device *ndev)
 
 		/* Since we have freed up a buffer, the ring is no longer full
 		 */
-		if (fep->tx_full) {
-			fep->tx_full = 0;
-			if (netif_queue_stopped(ndev))
-				netif_wake_queue(ndev);
-		}
+		fep->tx_full = 0;
 	}
 	fep->dirty_tx = bdp;
+
+	/* Wake the queue once a frame of any size fits again */
+	if (netif_queue_stopped(ndev) && fep->link &&
+	    fec_enet_tx_free_bds(fep) > MAX_SKB_FRAGS)
+		netif_wake_queue(ndev);
 	spin_unlock(&fep->hw_lock);
 }
 
+/*
+ * Build the skb of a received frame.  Frames longer than rx_copybreak
+ * are passed up in their DMA buffer, which is replaced by a new one.
+ * The FEC interrupt is taken by one CPU, and the copy used to be done
+ * there for every frame; now the payload is first read by the CPU that
+ * RPS steers the flow to.  This needs the two byte receive shift, which
+ * keeps the IP header aligned.  Returns NULL if the frame is dropped.
+ */
+static struct sk_buff *
+fec_enet_rx_skb(struct net_device *ndev, struct bufdesc *bdp, ushort pkt_len)
+{
+	struct fec_enet_private *fep = netdev_priv(ndev);
+	const struct platform_device_id *id_entry =
+				platform_get_device_id(fep->pdev);
+	int index = bdp - fep->rx_bd_base;
+	int shift = (id_entry->driver_data & FEC_QUIRK_HAS_RACC) ? 2 : 0;
+	struct sk_buff *skb;
+	__u8 *data;
+
+	data = fep->rx_skbuff[index]->data;
+	if (bdp->cbd_bufaddr)
+		dma_unmap_single(&fep->pdev->dev, bdp->cbd_bufaddr,
+			FEC_ENET_RX_FRSIZE, DMA_FROM_DEVICE);
+
+	if (id_entry->driver_data & FEC_QUIRK_SWAP_FRAME)
+		swap_buffer(data, pkt_len);
+
+	/* The packet length includes FCS, but we don't want to
+	 * include that when passing upstream as it messes up
+	 * bridging applications.
+	 */
+	pkt_len -= 4 + shift;
+
+	if (shift && pkt_len > rx_copybreak) {
+		struct sk_buff *new_skb = dev_alloc_skb(FEC_ENET_RX_FRSIZE);
+
+		/* without a new buffer, fall back to a copy */
+		if (new_skb) {
+			skb = fep->rx_skbuff[index];
+			skb_reserve(skb, shift);
+			skb_put(skb, pkt_len);
+
+			fep->rx_skbuff[index] = new_skb;
+			data = new_skb->data;
+			goto map;
+		}
+	}
+
+	/* This does 16 byte alignment, exactly what we need. */
+	skb = dev_alloc_skb(pkt_len + NET_IP_ALIGN);
+	if (likely(skb)) {
+		skb_reserve(skb, NET_IP_ALIGN);
+		skb_put(skb, pkt_len);	/* Make room */
+		skb_copy_to_linear_data(skb, data + shift, pkt_len);
+	}
+
+map:
+	bdp->cbd_bufaddr = dma_map_single(&fep->pdev->dev, data,
+			FEC_ENET_RX_FRSIZE, DMA_FROM_DEVICE);
+	return skb;
+}
+
+/*
+ * Set the flow hash RPS/RFS steer on.  The FEC has no hardware hash,
+ * but the IPv4 header is right behind the Ethernet header here, so this
+ * is much cheaper than the generic dissection get_rps_cpu() would do on
+ * the interrupt CPU otherwise.  Same inputs as __skb_get_rxhash():
+ * addresses, and ports unless the datagram is a fragment.
+ */
+static void fec_enet_rx_hash(struct fec_enet_private *fep, struct sk_buff *skb)
+{
+	const struct iphdr *iph = (const struct iphdr *)skb->data;
+	unsigned int ihl;
+	u32 ports = 0;
+	u32 hash;
+
+	if (skb->protocol != htons(ETH_P_IP) ||
+	    skb_headlen(skb) < sizeof(*iph) || iph->ihl < 5)
+		return;
+	ihl = iph->ihl * 4;
+
+	switch (iph->protocol) {
+	case IPPROTO_TCP:
+	case IPPROTO_UDP:
+	case IPPROTO_UDPLITE:
+	case IPPROTO_SCTP:
+	case IPPROTO_DCCP:
+		if (!(iph->frag_off & htons(IP_MF | IP_OFFSET)) &&
+		    skb_headlen(skb) >= ihl + 4)
+			ports = get_unaligned((u32 *)(skb->data + ihl));
+		break;
+	}
+
+	hash = jhash_3words((__force u32)iph->daddr, (__force u32)iph->saddr,
+			    ports, fep->rx_hash_rnd);
+	skb->rxhash = hash ? hash : 1;
+}
+
 /*NAPI polling Receive packets */
 static int fec_rx_poll(struct napi_struct *napi, int budget)
 {
@@ -567,14 +777,11 @@ static int fec_rx_poll(struct napi_struct *napi, int budget)
 		container_of(napi, struct fec_enet_private, napi);
 	struct net_device *ndev = napi->dev;
 	struct  fec_ptp_private *fpp = fep->ptp_priv;
-	const struct platform_device_id *id_entry =
-				platform_get_device_id(fep->pdev);
 	int pkt_received = 0;
 	struct bufdesc *bdp;
 	unsigned short status;
 	struct	sk_buff	*skb;
 	ushort	pkt_len;
-	__u8 *data;
 
 	if (fep->use_napi)
 		WARN_ON(!budget);
@@ -632,39 +839,21 @@ static int fec_rx_poll(struct napi_struct *napi, int budget)
 		ndev->stats.rx_packets++;
 		pkt_len = bdp->cbd_datlen;
 		ndev->stats.rx_bytes += pkt_len;
-		data = (__u8 *)__va(bdp->cbd_bufaddr);
-
-		if (bdp->cbd_bufaddr)
-			dma_unmap_single(&ndev->dev, bdp->cbd_bufaddr,
-				FEC_ENET_RX_FRSIZE, DMA_FROM_DEVICE);
-
-		if (id_entry->driver_data & FEC_QUIRK_SWAP_FRAME)
-			swap_buffer(data, pkt_len);
-
-		/* This does 16 byte alignment, exactly what we need.
-		 * The packet length includes FCS, but we don't want to
-		 * include that when passing upstream as it messes up
-		 * bridging applications.
-		 */
-		skb = dev_alloc_skb(pkt_len - 4 + NET_IP_ALIGN);
-
+		skb = fec_enet_rx_skb(ndev, bdp, pkt_len);
 		if (unlikely(!skb)) {
 			dev_err(&ndev->dev,
 			"%s: Memory squeeze, dropping packet.\n", ndev->name);
 			ndev->stats.rx_dropped++;
 		} else {
-			skb_reserve(skb, NET_IP_ALIGN);
-			skb_put(skb, pkt_len - 4);	/* Make room */
-			skb_copy_to_linear_data(skb, data, pkt_len - 4);
 			/* 1588 messeage TS handle */
 			if (fep->ptimer_present)
 				fec_ptp_store_rxstamp(fpp, skb, bdp);
 			skb->protocol = eth_type_trans(skb, ndev);
+			if (ndev->features & NETIF_F_RXHASH)
+				fec_enet_rx_hash(fep, skb);
 			netif_receive_skb(skb);
 		}
 
-		bdp->cbd_bufaddr = dma_map_single(&ndev->dev, data,
-				FEC_ENET_RX_FRSIZE, DMA_FROM_DEVICE);
 rx_processing_done:
 		/* Clear the status flags for this buffer */
 		status &= ~BD_ENET_RX_STATS;
@@ -709,13 +898,10 @@ fec_enet_rx(struct net_device *ndev)
 {
 	struct fec_enet_private *fep = netdev_priv(ndev);
 	struct  fec_ptp_private *fpp = fep->ptp_priv;
-	const struct platform_device_id *id_entry =
-				platform_get_device_id(fep->pdev);
 	struct bufdesc *bdp;
 	unsigned short status;
 	struct	sk_buff	*skb;
 	ushort	pkt_len;
-	__u8 *data;
 
 #ifdef CONFIG_M532x
 	flush_cache_all();
@@ -767,39 +953,21 @@ fec_enet_rx(struct net_device *ndev)
 		ndev->stats.rx_packets++;
 		pkt_len = bdp->cbd_datlen;
 		ndev->stats.rx_bytes += pkt_len;
-		data = (__u8*)__va(bdp->cbd_bufaddr);
-
-		if (bdp->cbd_bufaddr)
-			dma_unmap_single(&fep->pdev->dev, bdp->cbd_bufaddr,
-				FEC_ENET_TX_FRSIZE, DMA_FROM_DEVICE);
-
-		if (id_entry->driver_data & FEC_QUIRK_SWAP_FRAME)
-			swap_buffer(data, pkt_len);
-
-		/* This does 16 byte alignment, exactly what we need.
-		 * The packet length includes FCS, but we don't want to
-		 * include that when passing upstream as it messes up
-		 * bridging applications.
-		 */
-		skb = dev_alloc_skb(pkt_len - 4 + NET_IP_ALIGN);
-
+		skb = fec_enet_rx_skb(ndev, bdp, pkt_len);
 		if (unlikely(!skb)) {
 			printk("%s: Memory squeeze, dropping packet.\n",
 					ndev->name);
 			ndev->stats.rx_dropped++;
 		} else {
-			skb_reserve(skb, NET_IP_ALIGN);
-			skb_put(skb, pkt_len - 4);	/* Make room */
-			skb_copy_to_linear_data(skb, data, pkt_len - 4);
 			/* 1588 messeage TS handle */
 			if (fep->ptimer_present)
 				fec_ptp_store_rxstamp(fpp, skb, bdp);
 			skb->protocol = eth_type_trans(skb, ndev);
+			if (ndev->features & NETIF_F_RXHASH)
+				fec_enet_rx_hash(fep, skb);
 			netif_rx(skb);
 		}
 
-		bdp->cbd_bufaddr = dma_map_single(&fep->pdev->dev, data,
-				FEC_ENET_TX_FRSIZE, DMA_FROM_DEVICE);
 rx_processing_done:
 		/* Clear the status flags for this buffer */
 		status &= ~BD_ENET_RX_STATS;
@@ -934,6 +1102,37 @@ static void __inline__ fec_get_mac(struct net_device *ndev)
 /*
  * Phy section
  */
+/* Minimum sized frame on the wire, with preamble and interframe gap */
+#define FEC_MIN_FRAME_BITS	((ETH_ZLEN + ETH_FCS_LEN + 8 + 12) * 8)
+
+/*
+ * While the link is up, ask for its bandwidth in both directions and for
+ * an interrupt latency the RX ring absorbs at line rate.  The platform
+ * may cap the latency for as long as the interface is open.
+ */
+static void fec_enet_update_pm_qos(struct fec_enet_private *fep)
+{
+	struct fec_platform_data *pdata = fep->pdev->dev.platform_data;
+	struct phy_device *phy_dev = fep->phy_dev;
+	s32 latency = PM_QOS_DEFAULT_VALUE;
+	s32 bandwidth = 0;
+
+	if (!pm_qos_request_active(&fep->pm_qos_lat))
+		return;
+
+	if (fep->link && phy_dev->speed > 0) {
+		latency = RX_RING_SIZE * FEC_MIN_FRAME_BITS / phy_dev->speed;
+		bandwidth = phy_dev->speed * 1000 / 8 * 2;
+	}
+
+	if (pdata && pdata->cpu_dma_latency &&
+	    (latency == PM_QOS_DEFAULT_VALUE || latency > pdata->cpu_dma_latency))
+		latency = pdata->cpu_dma_latency;
+
+	pm_qos_update_request(&fep->pm_qos_lat, latency);
+	pm_qos_update_request(&fep->pm_qos_bw, bandwidth);
+}
+
 static void fec_enet_adjust_link(struct net_device *ndev)
 {
 	struct fec_enet_private *fep = netdev_priv(ndev);
@@ -978,6 +1177,7 @@ spin_unlock:
 		if (!phy_dev->link && phy_dev && pdata && pdata->power_hibernate)
 			pdata->power_hibernate(phy_dev);
 		phy_print_status(phy_dev);
+		fec_enet_update_pm_qos(fep);
 	}
 }
 
@@ -1339,6 +1539,54 @@ static int fec_enet_alloc_buffers(struct net_device *ndev)
 	return 0;
 }
 
+/*
+ * The PHY state machine is stopped while the MAC loops back, otherwise
+ * a link change would restart the controller out of loopback.  Marking
+ * the PHY link down under its lock keeps the halted state machine from
+ * calling fec_enet_adjust_link() once more.
+ */
+static void fec_enet_set_loopback(struct net_device *ndev, bool on)
+{
+	struct fec_enet_private *fep = netdev_priv(ndev);
+	struct phy_device *phy_dev = fep->phy_dev;
+	unsigned long flags;
+
+	if (on == !!fep->mac_loopback)
+		return;
+
+	if (on) {
+		if (phy_dev) {
+			phy_stop(phy_dev);
+			mutex_lock(&phy_dev->lock);
+			phy_dev->link = 0;
+			mutex_unlock(&phy_dev->lock);
+		}
+
+		spin_lock_irqsave(&fep->hw_lock, flags);
+		fep->mac_loopback = 1;
+		fec_restart(ndev, 1);
+		fep->link = 1;
+		spin_unlock_irqrestore(&fep->hw_lock, flags);
+
+		netif_carrier_on(ndev);
+		netif_wake_queue(ndev);
+		netdev_info(ndev, "internal MAC loopback enabled\n");
+	} else {
+		netif_carrier_off(ndev);
+
+		spin_lock_irqsave(&fep->hw_lock, flags);
+		fec_stop(ndev);
+		fep->mac_loopback = 0;
+		fep->link = 0;
+		spin_unlock_irqrestore(&fep->hw_lock, flags);
+
+		/* the state machine brings the link back up */
+		if (phy_dev)
+			phy_start(phy_dev);
+		netdev_info(ndev, "internal MAC loopback disabled\n");
+	}
+}
+
 static int
 fec_enet_open(struct net_device *ndev)
 {
@@ -1364,13 +1612,25 @@ fec_enet_open(struct net_device *ndev)
 		return ret;
 	}
 
+	pm_qos_add_request(&fep->pm_qos_lat, PM_QOS_CPU_DMA_LATENCY,
+			   PM_QOS_DEFAULT_VALUE);
+	pm_qos_add_request(&fep->pm_qos_bw, PM_QOS_BUS_BANDWIDTH,
+			   PM_QOS_DEFAULT_VALUE);
+	fec_enet_update_pm_qos(fep);
+
 	phy_start(fep->phy_dev);
 	netif_start_queue(ndev);
 	fep->opened = 1;
 
 	ret = -EINVAL;
-	if (pdata->init && pdata->init(fep->phy_dev))
+	if (pdata->init && pdata->init(fep->phy_dev)) {
+		pm_qos_remove_request(&fep->pm_qos_bw);
+		pm_qos_remove_request(&fep->pm_qos_lat);
 		return ret;
+	}
+
+	if (ndev->features & NETIF_F_LOOPBACK)
+		fec_enet_set_loopback(ndev, true);
 
 	return 0;
 }
@@ -1385,6 +1645,7 @@ fec_enet_close(struct net_device *ndev)
 		napi_disable(&fep->napi);
 
 	fec_stop(ndev);
+	fep->mac_loopback = 0;
 
 	if (fep->phy_dev) {
 		phy_stop(fep->phy_dev);
@@ -1396,6 +1657,9 @@ fec_enet_close(struct net_device *ndev)
 	/* Clock gate close for saving power */
 	clk_disable(fep->clk);
 
+	pm_qos_remove_request(&fep->pm_qos_bw);
+	pm_qos_remove_request(&fep->pm_qos_lat);
+
 	return 0;
 }
 
@@ -1498,6 +1762,16 @@ fec_set_mac_address(struct net_device *ndev, void *p)
 	return 0;
 }
 
+static int fec_set_features(struct net_device *ndev, u32 features)
+{
+	u32 changed = ndev->features ^ features;
+
+	if ((changed & NETIF_F_LOOPBACK) && netif_running(ndev))
+		fec_enet_set_loopback(ndev, !!(features & NETIF_F_LOOPBACK));
+
+	return 0;
+}
+
 static const struct net_device_ops fec_netdev_ops = {
 	.ndo_open		= fec_enet_open,
 	.ndo_stop		= fec_enet_close,
@@ -1508,6 +1782,7 @@ static const struct net_device_ops fec_netdev_ops = {
 	.ndo_tx_timeout		= fec_timeout,
 	.ndo_set_mac_address	= fec_set_mac_address,
 	.ndo_do_ioctl		= fec_enet_ioctl,
+	.ndo_set_features	= fec_set_features,
 #ifdef CONFIG_NET_POLL_CONTROLLER
 	.ndo_poll_controller    = fec_enet_netpoll,
 #endif
@@ -1542,6 +1817,8 @@ static void fec_enet_txbd_init(struct net_device *dev)
 static int fec_enet_init(struct net_device *ndev)
 {
 	struct fec_enet_private *fep = netdev_priv(ndev);
+	const struct platform_device_id *id_entry =
+				platform_get_device_id(fep->pdev);
 	struct bufdesc *cbd_base;
 	struct bufdesc *bdp;
 	int i;
@@ -1570,6 +1847,25 @@ static int fec_enet_init(struct net_device *ndev)
 	ndev->netdev_ops = &fec_netdev_ops;
 	ndev->ethtool_ops = &fec_enet_ethtool_ops;
 
+	/*
+	 * Scatter-gather lets PACKET_TX_RING frames go out from the ring
+	 * pages without a copy.  The stack only allows it together with a
+	 * checksum feature, so checksums are computed in the driver; that
+	 * costs TCP an extra pass over the data, so both are off until
+	 * enabled with "ethtool -K ethX tx on sg on".
+	 */
+	if (!(id_entry->driver_data & FEC_QUIRK_SWAP_FRAME))
+		ndev->hw_features = NETIF_F_SG | NETIF_F_HW_CSUM;
+
+	/* "ethtool -K ethX loopback on" for benchmarks without a link */
+	if (id_entry->driver_data & FEC_QUIRK_ENET_MAC)
+		ndev->hw_features |= NETIF_F_LOOPBACK;
+
+	/* Flow hash for RPS/RFS, "ethtool -K ethX rxhash off" to disable */
+	get_random_bytes(&fep->rx_hash_rnd, sizeof(fep->rx_hash_rnd));
+	ndev->hw_features |= NETIF_F_RXHASH;
+	ndev->features |= NETIF_F_RXHASH;
+
 	fep->use_napi = FEC_NAPI_ENABLE;
 	fep->napi_weight = FEC_NAPI_WEIGHT;
 	if (fep->use_napi) {
@@ -1639,6 +1935,12 @@ fec_restart(struct net_device *dev, int duplex)
 	/* Set maximum receive buffer size. */
 	writel(PKT_MAXBLR_SIZE, fep->hwp + FEC_R_BUFF_SIZE);
 
+	/* Start frames two bytes into the buffer to align the IP header */
+	if (id_entry->driver_data & FEC_QUIRK_HAS_RACC) {
+		val = readl(fep->hwp + FEC_RACC);
+		writel(val | FEC_RACC_SHIFT16, fep->hwp + FEC_RACC);
+	}
+
 	/* Set receive and transmit descriptor base. */
 	writel(fep->bd_dma, fep->hwp + FEC_R_DES_START);
 	writel((unsigned long)fep->bd_dma + sizeof(struct bufdesc) * RX_RING_SIZE,
@@ -1650,7 +1952,6 @@ fec_restart(struct net_device *dev, int duplex)
 	fep->cur_rx = fep->rx_bd_base;
 
 	/* Reset SKB transmit buffers. */
-	fep->skb_cur = fep->skb_dirty = 0;
 	for (i = 0; i <= TX_RING_MOD_MASK; i++) {
 		if (fep->tx_skbuff[i]) {
 			dev_kfree_skb_any(fep->tx_skbuff[i]);
@@ -1707,6 +2008,19 @@ fec_restart(struct net_device *dev, int duplex)
 		writel(val, fep->hwp + FEC_R_CNTRL);
 	}
 
+	/*
+	 * Internal loopback: the transmitter feeds the receiver from the
+	 * system clock and nothing goes out to the PHY.  It needs MII mode
+	 * and full duplex, which the callers ask for.
+	 */
+	if (fep->mac_loopback) {
+		val = readl(fep->hwp + FEC_R_CNTRL);
+		val &= ~(FEC_RCR_DRT | FEC_RCR_RGMII_EN | FEC_RCR_RMII_MODE |
+			 FEC_RCR_RMII_10T);
+		val |= FEC_RCR_LOOP;
+		writel(val, fep->hwp + FEC_R_CNTRL);
+	}
+
 	if (fep->ptimer_present) {
 		/* Set Timer count */
 		ret = fec_ptp_start(fep->ptp_priv);
@@ -1754,7 +2068,7 @@ fec_restart(struct net_device *dev, int duplex)
 	if (fep->phy_dev && (fep->phy_dev->supported &
 		(SUPPORTED_1000baseT_Half | SUPPORTED_1000baseT_Full)) &&
 		fep->phy_interface == PHY_INTERFACE_MODE_RGMII &&
-		fep->phy_dev->speed == SPEED_1000)
+		fep->phy_dev->speed == SPEED_1000 && !fep->mac_loopback)
 		val |= (0x1 << 5);
 
 	/* RX FIFO threshold setting for ENET pause frame feature
@@ -1863,6 +2177,9 @@ fec_probe(struct platform_device *pdev)
 
 	platform_set_drvdata(pdev, ndev);
 
+	/* the PHY hangs below us on the MDIO bus, so it still resumes after */
+	device_enable_async_suspend(&pdev->dev);
+
 	pdata = pdev->dev.platform_data;
 	if (pdata)
 		fep->phy_interface = pdata->phy;
@@ -46,6 +46,7 @@
 #include <linux/rational.h>
 #include <linux/slab.h>
 #include <linux/dma-mapping.h>
+#include <linux/pm_qos_params.h>
 #include <asm/uaccess.h>
 #include <linux/gpio.h>
 
@@ -216,6 +217,9 @@ struct imx_port {
 	unsigned int		dma_tx_nents;
 	bool			dma_is_rxing;
 	wait_queue_head_t	dma_wait;
+
+	/* RX FIFO overrun time at the current baud rate, while open */
+	struct pm_qos_request_list	pm_qos_req;
 };
 
 struct imx_port_ucrs {
@@ -1047,6 +1051,10 @@ static int imx_startup(struct uart_port *port)
 
 	clk_enable(sport->clk);
 
+	/* the real value follows from the baud rate in imx_set_termios() */
+	pm_qos_add_request(&sport->pm_qos_req, PM_QOS_CPU_DMA_LATENCY,
+			   PM_QOS_DEFAULT_VALUE);
+
 #ifndef CONFIG_SERIAL_CORE_CONSOLE
 	imx_setup_ufcr(sport, 0);
 #endif
@@ -1213,6 +1221,7 @@ error_out2:
 	if (sport->rxirq)
 		free_irq(sport->rxirq, sport);
 error_out1:
+	pm_qos_remove_request(&sport->pm_qos_req);
 	return retval;
 }
 
@@ -1288,6 +1297,7 @@ static void imx_shutdown(struct uart_port *port)
 	}
 	#endif
 	
+	pm_qos_remove_request(&sport->pm_qos_req);
 	clk_disable(sport->clk);
 }
 
@@ -1350,6 +1360,14 @@ imx_set_termios(struct uart_port *port, struct ktermios *termios,
 	baud = uart_get_baud_rate(port, termios, old, 50, port->uartclk / 16);
 	quot = uart_get_divisor(port, baud);
 
+	/*
+	 * The RX interrupt fires at RXTL characters and the FIFO overruns
+	 * once the rest of it has filled up, counting 10 bits a character.
+	 */
+	if (pm_qos_request_active(&sport->pm_qos_req))
+		pm_qos_update_request(&sport->pm_qos_req,
+			(port->fifosize - RXTL) * 10 * USEC_PER_SEC / baud);
+
 	del_timer_sync(&sport->timer);
 
 	spin_lock_irqsave(&sport->port.lock, flags);
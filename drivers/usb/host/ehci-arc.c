@@ -50,6 +50,24 @@ static void fsl_usb_clk_gate(struct fsl_usb2_platform_data *pdata, bool enable)
 	if (pdata->usb_clock_for_pm)
 		pdata->usb_clock_for_pm(enable);
 }
+
+/*
+ * A running controller may move a high speed port's worth of data and
+ * services the periodic schedule once a frame.
+ */
+#define EHCI_FSL_PM_QOS_LATENCY		1000	/* us */
+#define EHCI_FSL_PM_QOS_BW		60000	/* kB/s */
+
+static void fsl_usb_pm_qos(struct fsl_usb2_platform_data *pdata, bool active)
+{
+	if (!pm_qos_request_active(&pdata->pm_qos_bw))
+		return;
+
+	pm_qos_update_request(&pdata->pm_qos_lat, active ?
+			      EHCI_FSL_PM_QOS_LATENCY : PM_QOS_DEFAULT_VALUE);
+	pm_qos_update_request(&pdata->pm_qos_bw, active ?
+			      EHCI_FSL_PM_QOS_BW : PM_QOS_DEFAULT_VALUE);
+}
 #undef EHCI_PROC_PTC
 #ifdef EHCI_PROC_PTC		/* /proc PORTSC:PTC support */
 /*
@@ -285,6 +303,11 @@ int usb_hcd_fsl_probe(const struct hc_driver *driver,
 	if (retval != 0)
 		goto err5;
 
+	pm_qos_add_request(&pdata->pm_qos_lat, PM_QOS_CPU_DMA_LATENCY,
+			   EHCI_FSL_PM_QOS_LATENCY);
+	pm_qos_add_request(&pdata->pm_qos_bw, PM_QOS_BUS_BANDWIDTH,
+			   EHCI_FSL_PM_QOS_BW);
+
 	retval = usb_add_hcd(hcd, irq, IRQF_DISABLED | IRQF_SHARED);
 	if (retval != 0)
 		goto err6;
@@ -301,8 +324,11 @@ int usb_hcd_fsl_probe(const struct hc_driver *driver,
 
 	ehci = hcd_to_ehci(hcd);
 	pdata->pm_command = ehci->command;
+	device_enable_async_suspend(&pdev->dev);
 	return retval;
 err6:
+	pm_qos_remove_request(&pdata->pm_qos_bw);
+	pm_qos_remove_request(&pdata->pm_qos_lat);
 	free_irq(irq, (void *)pdev);
 err5:
 	otg_put_transceiver(ehci->transceiver);
@@ -364,6 +390,9 @@ static void usb_hcd_fsl_remove(struct usb_hcd *hcd,
 	usb_remove_hcd(hcd);
 	usb_put_hcd(hcd);
 
+	pm_qos_remove_request(&pdata->pm_qos_bw);
+	pm_qos_remove_request(&pdata->pm_qos_lat);
+
 	fsl_usb_lowpower_mode(pdata, true);
 
 	/* DDD shouldn't we turn off the power here? */
@@ -467,6 +496,7 @@ static int ehci_fsl_bus_suspend(struct usb_hcd *hcd)
 	fsl_usb_lowpower_mode(pdata, true);
 	fsl_usb_clk_gate(hcd->self.controller->platform_data, false);
 	clear_bit(HCD_FLAG_HW_ACCESSIBLE, &hcd->flags);
+	fsl_usb_pm_qos(pdata, false);
 	printk(KERN_DEBUG "%s ends, %s\n", __func__, pdata->name);
 
 	return ret;
@@ -488,6 +518,8 @@ static int ehci_fsl_bus_resume(struct usb_hcd *hcd)
 		return -ESHUTDOWN;
 	}
 
+	fsl_usb_pm_qos(pdata, true);
+
 	if (!test_bit(HCD_FLAG_HW_ACCESSIBLE, &hcd->flags)) {
 		fsl_usb_clk_gate(hcd->self.controller->platform_data, true);
 		usb_host_set_wakeup(hcd->self.controller, false);
@@ -769,6 +801,12 @@ static int ehci_fsl_drv_resume(struct platform_device *pdev)
 	struct fsl_usb2_wakeup_platform_data *wake_up_pdata = pdata->wakeup_pdata;
 	/* Only handles OTG mode switch event */
 	printk(KERN_DEBUG "ehci fsl drv resume begins: %s\n", pdata->name);
+	/*
+	 * We resume asynchronously, the OTG transceiver is not our parent
+	 * and has to be up before the port is touched.
+	 */
+	if (ehci->transceiver)
+		device_pm_wait_for_dev(&pdev->dev, ehci->transceiver->dev);
 	if (pdata->pmflags == 0) {
 		printk(KERN_DEBUG "%s,pm event, wait for wakeup irq if needed\n", __func__);
 		wait_event_interruptible(wake_up_pdata->wq, !wake_up_pdata->usb_wakeup_is_pending);
@@ -2434,9 +2434,18 @@ static int mxcfb_remove(struct platform_device *pdev)
 /*!
  * This structure contains pointers to the power management callback functions.
  */
+/*
+ * The display drivers register the dispdrv looked up in mxcfb_probe(), so
+ * they must be done probing even if they were made asynchronous.
+ */
+static const char * const mxcfb_probe_after[] = {
+	"mxc_hdmi", "mxc_lcdif", "mxc_ldb", "mxc_dvi", "mxc_mipi_dsi", NULL
+};
+
 static struct platform_driver mxcfb_driver = {
 	.driver = {
 		   .name = MXCFB_NAME,
+		   .probe_after = mxcfb_probe_after,
 		   },
 	.probe = mxcfb_probe,
 	.remove = mxcfb_remove,
@@ -33,6 +33,7 @@
 #include <linux/bitops.h>
 #include <linux/mutex.h>
 #include <linux/anon_inodes.h>
+#include <linux/percpu.h>
 #include <asm/uaccess.h>
 #include <asm/system.h>
 #include <asm/io.h>
@@ -85,6 +86,11 @@
  * Events that require holding "epmutex" are very rare, while for
  * normal operations the epoll private "ep->mtx" will guarantee
  * a better scalability.
+ * The poll callback itself takes none of these locks.  It pushes the
+ * item on a per-CPU ready stack of the eventpoll with cmpxchg(), and
+ * the stacks are merged into "ep->rdllist", under "ep->lock", when
+ * events are collected.  So a storm of wakeups on many CPUs does not
+ * bounce "ep->lock" around, and "ep->wq" has its own lock.
  */
 
 /* Epoll private bits inside the event mask */
@@ -135,8 +141,8 @@ struct epitem {
 	struct list_head rdllink;
 
 	/*
-	 * Works together "struct eventpoll"->ovflist in keeping the
-	 * single linked chain of items.
+	 * Links the item on a per-CPU ready stack of "struct eventpoll".
+	 * EP_UNACTIVE_PTR while it is on none.
 	 */
 	struct epitem *next;
 
@@ -189,11 +195,12 @@ struct eventpoll {
 	struct rb_root rbr;
 
 	/*
-	 * This is a single linked list that chains all the "struct epitem" that
-	 * happened while transferring ready events to userspace w/out
-	 * holding ->lock.
+	 * Per-CPU single linked stacks of the "struct epitem" reported ready
+	 * by the poll callback, not yet merged into rdllist.  They also keep
+	 * the events that happen while transferring ready events to
+	 * userspace w/out holding ->lock.
 	 */
-	struct epitem *ovflist;
+	struct epitem * __percpu *pcpu_ready;
 
 	/* The user that created the eventpoll descriptor */
 	struct user_struct *user;
@@ -235,6 +242,16 @@ struct ep_send_events_data {
 	struct epoll_event __user *events;
 };
 
+/* Counters reported in /proc/sys/fs/epoll/ */
+struct ep_stats {
+	unsigned long wakeups;	/* poll callbacks matching the interest */
+	unsigned long queued;	/* of those, the item was not ready yet */
+	unsigned long harvests;	/* merges of the per-CPU stacks */
+	unsigned long events;	/* events delivered to userspace */
+};
+
+static DEFINE_PER_CPU(struct ep_stats, ep_stats);
+
 /*
  * Configuration options available inside /proc/sys/fs/epoll/
  */
@@ -277,6 +294,32 @@ static LIST_HEAD(tfile_check_list);
 static long zero;
 static long long_max = LONG_MAX;
 
+static int proc_ep_stats(ctl_table *table, int write,
+			 void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	size_t offset = (unsigned long)table->extra1;
+	unsigned long sum = 0;
+	ctl_table t = *table;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		sum += *(unsigned long *)((char *)&per_cpu(ep_stats, cpu) +
+					  offset);
+
+	t.data = &sum;
+	t.extra1 = NULL;
+	return proc_doulongvec_minmax(&t, write, buffer, lenp, ppos);
+}
+
+#define EP_STAT(name)							\
+	{								\
+		.procname	= #name,				\
+		.maxlen		= sizeof(unsigned long),		\
+		.mode		= 0444,					\
+		.proc_handler	= proc_ep_stats,			\
+		.extra1		= (void *)offsetof(struct ep_stats, name), \
+	}
+
 ctl_table epoll_table[] = {
 	{
 		.procname	= "max_user_watches",
@@ -287,6 +330,10 @@ ctl_table epoll_table[] = {
 		.extra1		= &zero,
 		.extra2		= &long_max,
 	},
+	EP_STAT(wakeups),
+	EP_STAT(queued),
+	EP_STAT(harvests),
+	EP_STAT(events),
 	{ }
 };
 #endif /* CONFIG_SYSCTL */
@@ -360,7 +407,51 @@ static void ep_nested_calls_init(struct nested_calls *ncalls)
  */
 static inline int ep_events_available(struct eventpoll *ep)
 {
-	return !list_empty(&ep->rdllist) || ep->ovflist != EP_UNACTIVE_PTR;
+	int cpu;
+
+	if (!list_empty(&ep->rdllist))
+		return 1;
+
+	for_each_possible_cpu(cpu)
+		if (*per_cpu_ptr(ep->pcpu_ready, cpu))
+			return 1;
+
+	return 0;
+}
+
+/*
+ * Moves the items of the per-CPU ready stacks to the ready list, in the
+ * order they were reported on each CPU.  Items that are already on the
+ * ready list, or on the list being transferred to userspace, are left
+ * there.  Must be called with "ep->lock" held.
+ */
+static void ep_merge_ready(struct eventpoll *ep)
+{
+	struct epitem *epi, *nepi, *txl;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct epitem **head = per_cpu_ptr(ep->pcpu_ready, cpu);
+
+		if (!*head)
+			continue;
+
+		/* take the whole stack and reverse it */
+		txl = NULL;
+		for (nepi = xchg(head, NULL); (epi = nepi) != NULL; txl = epi) {
+			nepi = epi->next;
+			epi->next = txl;
+		}
+
+		for (nepi = txl; (epi = nepi) != NULL;) {
+			nepi = epi->next;
+			/* from here on the poll callback may push it again */
+			epi->next = EP_UNACTIVE_PTR;
+			if (!ep_is_linked(&epi->rdllink))
+				list_add_tail(&epi->rdllink, &ep->rdllist);
+		}
+		this_cpu_inc(ep_stats.harvests);
+	}
 }
 
 /**
@@ -523,7 +614,6 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 {
 	int error, pwake = 0;
 	unsigned long flags;
-	struct epitem *epi, *nepi;
 	LIST_HEAD(txlist);
 
 	/*
@@ -534,15 +624,14 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 
 	/*
 	 * Steal the ready list, and re-init the original one to the
-	 * empty list. Also, set ep->ovflist to NULL so that events
-	 * happening while looping w/out locks, are not lost. We cannot
-	 * have the poll callback to queue directly on ep->rdllist,
-	 * because we want the "sproc" callback to be able to do it
-	 * in a lockless way.
+	 * empty list. Events happening while looping w/out locks stay
+	 * on the per-CPU stacks, the poll callback never queues directly
+	 * on ep->rdllist, so the "sproc" callback can do it in a
+	 * lockless way.
 	 */
 	spin_lock_irqsave(&ep->lock, flags);
+	ep_merge_ready(ep);
 	list_splice_init(&ep->rdllist, &txlist);
-	ep->ovflist = NULL;
 	spin_unlock_irqrestore(&ep->lock, flags);
 
 	/*
@@ -554,25 +643,11 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 	/*
 	 * During the time we spent inside the "sproc" callback, some
 	 * other events might have been queued by the poll callback.
-	 * We re-insert them inside the main ready-list here.
+	 * We re-insert them inside the main ready-list here; the items
+	 * still on "txlist" are left alone, the list_splice() below
+	 * takes care of them.
 	 */
-	for (nepi = ep->ovflist; (epi = nepi) != NULL;
-	     nepi = epi->next, epi->next = EP_UNACTIVE_PTR) {
-		/*
-		 * We need to check if the item is already in the list.
-		 * During the "sproc" callback execution time, items are
-		 * queued into ->ovflist but the "txlist" might already
-		 * contain them, and the list_splice() below takes care of them.
-		 */
-		if (!ep_is_linked(&epi->rdllink))
-			list_add_tail(&epi->rdllink, &ep->rdllist);
-	}
-	/*
-	 * We need to set back ep->ovflist to EP_UNACTIVE_PTR, so that after
-	 * releasing the lock, events will be queued in the normal way inside
-	 * ep->rdllist.
-	 */
-	ep->ovflist = EP_UNACTIVE_PTR;
+	ep_merge_ready(ep);
 
 	/*
 	 * Quickly re-inject items left on "txlist".
@@ -585,7 +660,7 @@ static int ep_scan_ready_list(struct eventpoll *ep,
 		 * the ->poll() wait list (delayed after we release the lock).
 		 */
 		if (waitqueue_active(&ep->wq))
-			wake_up_locked(&ep->wq);
+			wake_up(&ep->wq);
 		if (waitqueue_active(&ep->poll_wait))
 			pwake++;
 	}
@@ -627,7 +702,9 @@ static int ep_remove(struct eventpoll *ep, struct epitem *epi)
 
 	rb_erase(&epi->rbn, &ep->rbr);
 
+	/* The item may still sit on a per-CPU stack, merge them first */
 	spin_lock_irqsave(&ep->lock, flags);
+	ep_merge_ready(ep);
 	if (ep_is_linked(&epi->rdllink))
 		list_del_init(&epi->rdllink);
 	spin_unlock_irqrestore(&ep->lock, flags);
@@ -682,6 +759,7 @@ static void ep_free(struct eventpoll *ep)
 	mutex_unlock(&epmutex);
 	mutex_destroy(&ep->mtx);
 	free_uid(ep->user);
+	free_percpu(ep->pcpu_ready);
 	kfree(ep);
 }
 
@@ -800,19 +878,24 @@ static int ep_alloc(struct eventpoll **pep)
 	if (unlikely(!ep))
 		goto free_uid;
 
+	ep->pcpu_ready = alloc_percpu(struct epitem *);
+	if (unlikely(!ep->pcpu_ready))
+		goto free_ep;
+
 	spin_lock_init(&ep->lock);
 	mutex_init(&ep->mtx);
 	init_waitqueue_head(&ep->wq);
 	init_waitqueue_head(&ep->poll_wait);
 	INIT_LIST_HEAD(&ep->rdllist);
 	ep->rbr = RB_ROOT;
-	ep->ovflist = EP_UNACTIVE_PTR;
 	ep->user = user;
 
 	*pep = ep;
 
 	return 0;
 
+free_ep:
+	kfree(ep);
 free_uid:
 	free_uid(user);
 	return error;
@@ -854,10 +937,9 @@ static struct epitem *ep_find(struct eventpoll *ep, struct file *file, int fd)
  */
 static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *key)
 {
-	int pwake = 0;
-	unsigned long flags;
 	struct epitem *epi = ep_item_from_wait(wait);
 	struct eventpoll *ep = epi->ep;
+	struct epitem **head, *old;
 
 	if ((unsigned long)key & POLLFREE) {
 		ep_pwq_from_wait(wait)->whead = NULL;
@@ -870,8 +952,6 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 		list_del_init(&wait->task_list);
 	}
 
-	spin_lock_irqsave(&ep->lock, flags);
-
 	/*
 	 * If the event mask does not contain any poll(2) event, we consider the
 	 * descriptor to be disabled. This condition is likely the effect of the
@@ -879,7 +959,7 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 	 * until the next EPOLL_CTL_MOD will be issued.
 	 */
 	if (!(epi->event.events & ~EP_PRIVATE_BITS))
-		goto out_unlock;
+		return 1;
 
 	/*
 	 * Check the events coming with the callback. At this stage, not
@@ -888,40 +968,36 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 	 * test for "key" != NULL before the event match test.
 	 */
 	if (key && !((unsigned long) key & epi->event.events))
-		goto out_unlock;
+		return 1;
+
+	this_cpu_inc(ep_stats.wakeups);
 
 	/*
-	 * If we are transferring events to userspace, we can hold no locks
-	 * (because we're accessing user memory, and because of linux f_op->poll()
-	 * semantics). All the events that happen during that period of time are
-	 * chained in ep->ovflist and requeued later on.
+	 * If the item is already on a per-CPU stack, whoever pushed it did
+	 * the wake ups and the next merge will see it.  Otherwise claim it
+	 * and push it on the stack of this CPU; whead->lock is held, so we
+	 * can't migrate.  A transfer to userspace running meanwhile picks
+	 * it up when it merges the stacks at its end.
 	 */
-	if (unlikely(ep->ovflist != EP_UNACTIVE_PTR)) {
-		if (epi->next == EP_UNACTIVE_PTR) {
-			epi->next = ep->ovflist;
-			ep->ovflist = epi;
-		}
-		goto out_unlock;
-	}
+	if (cmpxchg(&epi->next, EP_UNACTIVE_PTR, NULL) != EP_UNACTIVE_PTR)
+		return 1;
 
-	/* If this file is already in the ready list we exit soon */
-	if (!ep_is_linked(&epi->rdllink))
-		list_add_tail(&epi->rdllink, &ep->rdllist);
+	head = this_cpu_ptr(ep->pcpu_ready);
+	do {
+		old = *head;
+		epi->next = old;
+	} while (cmpxchg(head, old, epi) != old);
+
+	this_cpu_inc(ep_stats.queued);
 
 	/*
 	 * Wake up ( if active ) both the eventpoll wait list and the ->poll()
-	 * wait list.
+	 * wait list.  The cmpxchg() above orders the push before the checks,
+	 * against a waiter that adds itself and then looks at the stacks.
 	 */
 	if (waitqueue_active(&ep->wq))
-		wake_up_locked(&ep->wq);
+		wake_up(&ep->wq);
 	if (waitqueue_active(&ep->poll_wait))
-		pwake++;
-
-out_unlock:
-	spin_unlock_irqrestore(&ep->lock, flags);
-
-	/* We have to call this outside the lock */
-	if (pwake)
 		ep_poll_safewake(&ep->poll_wait);
 
 	return 1;
@@ -1141,7 +1217,7 @@ static int ep_insert(struct eventpoll *ep, struct epoll_event *event,
 
 		/* Notify waiting tasks that events are available */
 		if (waitqueue_active(&ep->wq))
-			wake_up_locked(&ep->wq);
+			wake_up(&ep->wq);
 		if (waitqueue_active(&ep->poll_wait))
 			pwake++;
 	}
@@ -1169,11 +1245,10 @@ error_unregister:
 
 	/*
 	 * We need to do this because an event could have been arrived on some
-	 * allocated wait queue. Note that we don't care about the ep->ovflist
-	 * list, since that is used/cleaned only inside a section bound by "mtx".
-	 * And ep_insert() is called with "mtx" held.
+	 * allocated wait queue, and the item pushed on a per-CPU stack.
 	 */
 	spin_lock_irqsave(&ep->lock, flags);
+	ep_merge_ready(ep);
 	if (ep_is_linked(&epi->rdllink))
 		list_del_init(&epi->rdllink);
 	spin_unlock_irqrestore(&ep->lock, flags);
@@ -1217,7 +1292,7 @@ static int ep_modify(struct eventpoll *ep, struct epitem *epi, struct epoll_even
 
 			/* Notify waiting tasks that events are available */
 			if (waitqueue_active(&ep->wq))
-				wake_up_locked(&ep->wq);
+				wake_up(&ep->wq);
 			if (waitqueue_active(&ep->poll_wait))
 				pwake++;
 		}
@@ -1280,7 +1355,7 @@ static int ep_send_events_proc(struct eventpoll *ep, struct list_head *head,
 				 * into ep->rdllist besides us. The epoll_ctl()
 				 * callers are locked out by
 				 * ep_scan_ready_list() holding "mtx" and the
-				 * poll callback will queue them in ep->ovflist.
+				 * poll callback queues on the per-CPU stacks.
 				 */
 				list_add_tail(&epi->rdllink, &ep->rdllist);
 			}
@@ -1294,11 +1369,16 @@ static int ep_send_events(struct eventpoll *ep,
 			  struct epoll_event __user *events, int maxevents)
 {
 	struct ep_send_events_data esed;
+	int res;
 
 	esed.maxevents = maxevents;
 	esed.events = events;
 
-	return ep_scan_ready_list(ep, ep_send_events_proc, &esed, 0);
+	res = ep_scan_ready_list(ep, ep_send_events_proc, &esed, 0);
+	if (res > 0)
+		this_cpu_add(ep_stats.events, res);
+
+	return res;
 }
 
 static inline struct timespec ep_set_mstimeout(long ms)
@@ -1364,7 +1444,7 @@ fetch_events:
 		 * ep_poll_callback() when events will become available.
 		 */
 		init_waitqueue_entry(&wait, current);
-		__add_wait_queue_exclusive(&ep->wq, &wait);
+		add_wait_queue_exclusive(&ep->wq, &wait);
 
 		for (;;) {
 			/*
@@ -1386,7 +1466,7 @@ fetch_events:
 
 			spin_lock_irqsave(&ep->lock, flags);
 		}
-		__remove_wait_queue(&ep->wq, &wait);
+		remove_wait_queue(&ep->wq, &wait);
 
 		set_current_state(TASK_RUNNING);
 	}
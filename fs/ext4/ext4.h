@@ -917,6 +917,8 @@ struct ext4_inode_info {
 #define EXT4_MOUNT_DISCARD		0x40000000 /* Issue DISCARD requests */
 #define EXT4_MOUNT_INIT_INODE_TABLE	0x80000000 /* Initialize uninitialized itables */
 
+#define EXT4_MOUNT2_DISCARD_BG		0x00000001 /* Background DISCARD */
+
 #define clear_opt(sb, opt)		EXT4_SB(sb)->s_mount_opt &= \
 						~EXT4_MOUNT_##opt
 #define set_opt(sb, opt)		EXT4_SB(sb)->s_mount_opt |= \
@@ -1215,6 +1217,15 @@ struct ext4_sb_info {
 
 	/* Kernel thread for multiple mount protection */
 	struct task_struct *s_mmp_tsk;
+
+	/* Background discard of freed extents */
+	struct task_struct *s_discard_tsk;
+	spinlock_t s_discard_lock;
+	struct rb_root s_discard_root;	/* pending ext4_free_data extents */
+	unsigned long s_discard_nr;	/* number of pending extents */
+	unsigned long s_discard_blocks;	/* blocks in them */
+	unsigned int s_discard_interval; /* idle check period in ms */
+	unsigned int s_discard_max_mb;	/* to discard per period */
 };
 
 static inline struct ext4_sb_info *EXT4_SB(struct super_block *sb)
@@ -1797,6 +1808,8 @@ extern int ext4_mb_add_groupinfo(struct super_block *sb,
 extern void ext4_add_groupblocks(handle_t *handle, struct super_block *sb,
 				ext4_fsblk_t block, unsigned long count);
 extern int ext4_trim_fs(struct super_block *, struct fstrim_range *);
+extern int ext4_mb_start_discard_thread(struct super_block *);
+extern void ext4_mb_stop_discard_thread(struct super_block *);
 
 /* inode.c */
 struct buffer_head *ext4_getblk(handle_t *, struct inode *,
@@ -23,6 +23,9 @@
 
 #include "mballoc.h"
 #include <linux/debugfs.h>
+#include <linux/freezer.h>
+#include <linux/genhd.h>
+#include <linux/kthread.h>
 #include <linux/slab.h>
 #include <trace/events/ext4.h>
 
@@ -2473,6 +2476,11 @@ int ext4_mb_init(struct super_block *sb, int needs_recovery)
 	sbi->s_mb_order2_reqs = MB_DEFAULT_ORDER2_REQS;
 	sbi->s_mb_group_prealloc = MB_DEFAULT_GROUP_PREALLOC;
 
+	spin_lock_init(&sbi->s_discard_lock);
+	sbi->s_discard_root = RB_ROOT;
+	sbi->s_discard_interval = MB_DEFAULT_DISCARD_INTERVAL;
+	sbi->s_discard_max_mb = MB_DEFAULT_DISCARD_MAX_MB;
+
 	sbi->s_locality_groups = alloc_percpu(struct ext4_locality_group);
 	if (sbi->s_locality_groups == NULL) {
 		ret = -ENOMEM;
@@ -2519,6 +2527,22 @@ static void ext4_mb_cleanup_pa(struct ext4_group_info *grp)
 
 }
 
+/* drop the extents still waiting for the background discard */
+static void ext4_mb_free_discard_pending(struct ext4_sb_info *sbi)
+{
+	struct rb_node *n;
+
+	spin_lock(&sbi->s_discard_lock);
+	while ((n = rb_first(&sbi->s_discard_root)) != NULL) {
+		rb_erase(n, &sbi->s_discard_root);
+		kmem_cache_free(ext4_free_ext_cachep,
+				rb_entry(n, struct ext4_free_data, node));
+	}
+	sbi->s_discard_nr = 0;
+	sbi->s_discard_blocks = 0;
+	spin_unlock(&sbi->s_discard_lock);
+}
+
 int ext4_mb_release(struct super_block *sb)
 {
 	ext4_group_t ngroups = ext4_get_groups_count(sb);
@@ -2531,6 +2555,8 @@ int ext4_mb_release(struct super_block *sb)
 	if (sbi->s_proc)
 		remove_proc_entry("mb_groups", sbi->s_proc);
 
+	ext4_mb_free_discard_pending(sbi);
+
 	if (sbi->s_group_info) {
 		for (i = 0; i < ngroups; i++) {
 			grinfo = ext4_get_group_info(sb, i);
@@ -2593,6 +2619,81 @@ static inline int ext4_issue_discard(struct super_block *sb,
 	return sb_issue_discard(sb, discard_block, count, GFP_NOFS, 0);
 }
 
+static inline int ext4_discard_before(struct ext4_free_data *a,
+				      struct ext4_free_data *b)
+{
+	return a->group < b->group ||
+	       (a->group == b->group && a->start_blk < b->start_blk);
+}
+
+/* fold @second into @first, they are of the same group and touch */
+static void ext4_mb_merge_discard(struct ext4_sb_info *sbi,
+				  struct ext4_free_data *first,
+				  struct ext4_free_data *second)
+{
+	ext4_grpblk_t end = max(first->start_blk + first->count,
+				second->start_blk + second->count);
+
+	sbi->s_discard_blocks -= first->count + second->count;
+	first->count = end - first->start_blk;
+	sbi->s_discard_blocks += first->count;
+
+	rb_erase(&second->node, &sbi->s_discard_root);
+	sbi->s_discard_nr--;
+	kmem_cache_free(ext4_free_ext_cachep, second);
+}
+
+static inline int ext4_discard_touch(struct ext4_free_data *first,
+				     struct ext4_free_data *second)
+{
+	return first->group == second->group &&
+	       first->start_blk + first->count >= second->start_blk;
+}
+
+/*
+ * Queue a freed extent for the background discard thread, merged with the
+ * pending extents it touches so that the device gets few large discards.
+ * The entry is reused, it is off the group's free tree by now.
+ */
+static void ext4_mb_queue_discard(struct super_block *sb,
+				  struct ext4_free_data *new)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct rb_node **n = &sbi->s_discard_root.rb_node;
+	struct rb_node *parent = NULL, *node;
+	struct ext4_free_data *entry;
+
+	spin_lock(&sbi->s_discard_lock);
+	while (*n) {
+		parent = *n;
+		entry = rb_entry(parent, struct ext4_free_data, node);
+		if (ext4_discard_before(new, entry))
+			n = &(*n)->rb_left;
+		else
+			n = &(*n)->rb_right;
+	}
+	rb_link_node(&new->node, parent, n);
+	rb_insert_color(&new->node, &sbi->s_discard_root);
+	sbi->s_discard_nr++;
+	sbi->s_discard_blocks += new->count;
+
+	node = rb_prev(&new->node);
+	if (node) {
+		entry = rb_entry(node, struct ext4_free_data, node);
+		if (ext4_discard_touch(entry, new)) {
+			ext4_mb_merge_discard(sbi, entry, new);
+			new = entry;
+		}
+	}
+	node = rb_next(&new->node);
+	if (node) {
+		entry = rb_entry(node, struct ext4_free_data, node);
+		if (ext4_discard_touch(new, entry))
+			ext4_mb_merge_discard(sbi, new, entry);
+	}
+	spin_unlock(&sbi->s_discard_lock);
+}
+
 /*
  * This function is called by the jbd2 layer once the commit has finished,
  * so we know we can free the blocks that were released with that commit.
@@ -2637,7 +2738,10 @@ static void release_blocks_on_commit(journal_t *journal, transaction_t *txn)
 			page_cache_release(e4b.bd_bitmap_page);
 		}
 		ext4_unlock_group(sb, entry->group);
-		kmem_cache_free(ext4_free_ext_cachep, entry);
+		if (test_opt2(sb, DISCARD_BG))
+			ext4_mb_queue_discard(sb, entry);
+		else
+			kmem_cache_free(ext4_free_ext_cachep, entry);
 		ext4_mb_unload_buddy(&e4b);
 	}
 
@@ -4956,3 +5060,150 @@ int ext4_trim_fs(struct super_block *sb, struct fstrim_range *range)
 
 	return ret;
 }
+
+/*
+ * Background discard.
+ *
+ * With -o discard=background the extents freed by each commit are not
+ * discarded right away, which stalls the commit and fsync() behind many
+ * small discards.  They are queued, merged, on sbi->s_discard_root and a
+ * per filesystem thread discards them when the disk has been idle for
+ * s_discard_interval, at most s_discard_max_mb at a time.  The blocks are
+ * back in the buddy meanwhile: like FITRIM, only the parts still free are
+ * discarded, marked in use while the discard is in flight.
+ */
+static unsigned long ext4_mb_disk_ios(struct super_block *sb)
+{
+	struct hd_struct *part = &sb->s_bdev->bd_disk->part0;
+
+	return part_stat_read(part, ios[READ]) +
+	       part_stat_read(part, ios[WRITE]);
+}
+
+/* no I/O completed since *@ios was sampled and none in flight */
+static int ext4_mb_disk_idle(struct super_block *sb, unsigned long *ios)
+{
+	unsigned long now = ext4_mb_disk_ios(sb);
+	int idle = now == *ios &&
+		   !part_in_flight(&sb->s_bdev->bd_disk->part0);
+
+	*ios = now;
+	return idle;
+}
+
+static void ext4_mb_discard_pending(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	unsigned long budget;
+	struct ext4_free_data *entry;
+	struct rb_node *n;
+	ext4_grpblk_t ret;
+
+	budget = (unsigned long)sbi->s_discard_max_mb <<
+		 (20 - sb->s_blocksize_bits);
+
+	while (budget && !kthread_should_stop()) {
+		spin_lock(&sbi->s_discard_lock);
+		n = rb_first(&sbi->s_discard_root);
+		if (!n) {
+			spin_unlock(&sbi->s_discard_lock);
+			break;
+		}
+		entry = rb_entry(n, struct ext4_free_data, node);
+		rb_erase(n, &sbi->s_discard_root);
+		sbi->s_discard_nr--;
+		sbi->s_discard_blocks -= entry->count;
+		spin_unlock(&sbi->s_discard_lock);
+
+		ret = ext4_trim_all_free(sb, entry->group, entry->start_blk,
+					 entry->start_blk + entry->count, 1);
+		if (ret < 0)
+			ext4_msg(sb, KERN_WARNING, "background discard of "
+				 "group %u failed (%d)", entry->group, ret);
+
+		budget -= min_t(unsigned long, budget, entry->count);
+		kmem_cache_free(ext4_free_ext_cachep, entry);
+		cond_resched();
+	}
+}
+
+static int ext4_mb_discard_thread(void *data)
+{
+	struct super_block *sb = data;
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	unsigned long ios = ext4_mb_disk_ios(sb);
+
+	set_freezable();
+	while (!kthread_should_stop()) {
+		schedule_timeout_interruptible(
+			msecs_to_jiffies(max(sbi->s_discard_interval, 10U)));
+		try_to_freeze();
+
+		if (!ext4_mb_disk_idle(sb, &ios) &&
+		    sbi->s_discard_nr < MB_DISCARD_MAX_PENDING)
+			continue;
+
+		ext4_mb_discard_pending(sb);
+		/* our own discards do not count as activity */
+		ios = ext4_mb_disk_ios(sb);
+	}
+
+	return 0;
+}
+
+/**
+ * ext4_mb_start_discard_thread() -- start the background discard thread
+ * @sb:			superblock for filesystem
+ *
+ * Does nothing if it runs already.  If the device cannot discard, the
+ * discard=background option is dropped; if the thread cannot be started,
+ * it is replaced by the inline discard option.
+ */
+int ext4_mb_start_discard_thread(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct task_struct *t;
+
+	if (sbi->s_discard_tsk)
+		return 0;
+
+	if (!blk_queue_discard(bdev_get_queue(sb->s_bdev))) {
+		ext4_msg(sb, KERN_WARNING, "discard=background: device "
+			 "does not support discard");
+		clear_opt2(sb, DISCARD_BG);
+		return -EOPNOTSUPP;
+	}
+
+	t = kthread_run(ext4_mb_discard_thread, sb, "ext4-discard/%s",
+			sb->s_id);
+	if (IS_ERR(t)) {
+		ext4_msg(sb, KERN_WARNING, "failed to start the discard "
+			 "thread (%ld), falling back to discard", PTR_ERR(t));
+		clear_opt2(sb, DISCARD_BG);
+		set_opt(sb, DISCARD);
+		ext4_mb_free_discard_pending(sbi);
+		return PTR_ERR(t);
+	}
+	sbi->s_discard_tsk = t;
+
+	return 0;
+}
+
+/**
+ * ext4_mb_stop_discard_thread() -- stop the background discard thread
+ * @sb:			superblock for filesystem
+ *
+ * The pending extents are kept while discard=background stays set, for a
+ * remount read-write, and dropped otherwise.
+ */
+void ext4_mb_stop_discard_thread(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+
+	if (sbi->s_discard_tsk) {
+		kthread_stop(sbi->s_discard_tsk);
+		sbi->s_discard_tsk = NULL;
+	}
+	if (!test_opt2(sb, DISCARD_BG))
+		ext4_mb_free_discard_pending(sbi);
+}
@@ -94,6 +94,18 @@ extern u8 mb_enable_debug;
  */
 #define MB_DEFAULT_GROUP_PREALLOC	512
 
+/*
+ * background discard: look for an idle device every second, then
+ * discard up to 64MB of the freed extents
+ */
+#define MB_DEFAULT_DISCARD_INTERVAL	1000
+#define MB_DEFAULT_DISCARD_MAX_MB	64
+
+/*
+ * with this many extents pending, discard even if the device is busy
+ */
+#define MB_DISCARD_MAX_PENDING		32768
+
 
 struct ext4_free_data {
 	/* this links the free block information from group_info */
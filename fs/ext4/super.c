@@ -756,6 +756,7 @@ static void ext4_put_super(struct super_block *sb)
 	int i, err;
 
 	ext4_unregister_li_request(sb);
+	ext4_mb_stop_discard_thread(sb);
 	dquot_disable(sb, -1, DQUOT_USAGE_ENABLED | DQUOT_LIMITS_ENABLED);
 
 	flush_workqueue(sbi->dio_unwritten_wq);
@@ -1103,6 +1104,9 @@ static int ext4_show_options(struct seq_file *seq, struct vfsmount *vfs)
 	if (test_opt(sb, DISCARD) && !(def_mount_opts & EXT4_DEFM_DISCARD))
 		seq_puts(seq, ",discard");
 
+	if (test_opt2(sb, DISCARD_BG))
+		seq_puts(seq, ",discard=background");
+
 	if (test_opt(sb, NOLOAD))
 		seq_puts(seq, ",norecovery");
 
@@ -1292,7 +1296,8 @@ enum {
 	Opt_nomblk_io_submit, Opt_block_validity, Opt_noblock_validity,
 	Opt_inode_readahead_blks, Opt_journal_ioprio,
 	Opt_dioread_nolock, Opt_dioread_lock,
-	Opt_discard, Opt_nodiscard, Opt_init_itable, Opt_noinit_itable,
+	Opt_discard, Opt_discard_bg, Opt_nodiscard, Opt_init_itable,
+	Opt_noinit_itable,
 };
 
 static const match_table_t tokens = {
@@ -1364,6 +1369,7 @@ static const match_table_t tokens = {
 	{Opt_dioread_nolock, "dioread_nolock"},
 	{Opt_dioread_lock, "dioread_lock"},
 	{Opt_discard, "discard"},
+	{Opt_discard_bg, "discard=background"},
 	{Opt_nodiscard, "nodiscard"},
 	{Opt_init_itable, "init_itable=%u"},
 	{Opt_init_itable, "init_itable"},
@@ -1834,9 +1840,15 @@ set_qf_format:
 			break;
 		case Opt_discard:
 			set_opt(sb, DISCARD);
+			clear_opt2(sb, DISCARD_BG);
+			break;
+		case Opt_discard_bg:
+			clear_opt(sb, DISCARD);
+			set_opt2(sb, DISCARD_BG);
 			break;
 		case Opt_nodiscard:
 			clear_opt(sb, DISCARD);
+			clear_opt2(sb, DISCARD_BG);
 			break;
 		case Opt_dioread_nolock:
 			set_opt(sb, DIOREAD_NOLOCK);
@@ -2462,6 +2474,12 @@ static ssize_t extent_cache_misses_show(struct ext4_attr *a,
 	return snprintf(buf, PAGE_SIZE, "%lu\n", sbi->extent_cache_misses);
 }
 
+static ssize_t discard_pending_blocks_show(struct ext4_attr *a,
+					   struct ext4_sb_info *sbi, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%lu\n", sbi->s_discard_blocks);
+}
+
 static ssize_t inode_readahead_blks_store(struct ext4_attr *a,
 					  struct ext4_sb_info *sbi,
 					  const char *buf, size_t count)
@@ -2521,6 +2539,7 @@ EXT4_RO_ATTR(session_write_kbytes);
 EXT4_RO_ATTR(lifetime_write_kbytes);
 EXT4_RO_ATTR(extent_cache_hits);
 EXT4_RO_ATTR(extent_cache_misses);
+EXT4_RO_ATTR(discard_pending_blocks);
 EXT4_ATTR_OFFSET(inode_readahead_blks, 0644, sbi_ui_show,
 		 inode_readahead_blks_store, s_inode_readahead_blks);
 EXT4_RW_ATTR_SBI_UI(inode_goal, s_inode_goal);
@@ -2531,6 +2550,8 @@ EXT4_RW_ATTR_SBI_UI(mb_order2_req, s_mb_order2_reqs);
 EXT4_RW_ATTR_SBI_UI(mb_stream_req, s_mb_stream_request);
 EXT4_RW_ATTR_SBI_UI(mb_group_prealloc, s_mb_group_prealloc);
 EXT4_RW_ATTR_SBI_UI(max_writeback_mb_bump, s_max_writeback_mb_bump);
+EXT4_RW_ATTR_SBI_UI(discard_interval_ms, s_discard_interval);
+EXT4_RW_ATTR_SBI_UI(discard_max_mb, s_discard_max_mb);
 
 static struct attribute *ext4_attrs[] = {
 	ATTR_LIST(delayed_allocation_blocks),
@@ -2547,6 +2568,9 @@ static struct attribute *ext4_attrs[] = {
 	ATTR_LIST(mb_stream_req),
 	ATTR_LIST(mb_group_prealloc),
 	ATTR_LIST(max_writeback_mb_bump),
+	ATTR_LIST(discard_pending_blocks),
+	ATTR_LIST(discard_interval_ms),
+	ATTR_LIST(discard_max_mb),
 	NULL,
 };
 
@@ -3702,6 +3726,8 @@ no_journal:
 		ext4_msg(sb, KERN_INFO, "recovery complete");
 		ext4_mark_recovery_complete(sb, es);
 	}
+	if (test_opt2(sb, DISCARD_BG) && !(sb->s_flags & MS_RDONLY))
+		ext4_mb_start_discard_thread(sb);
 	if (EXT4_SB(sb)->s_journal) {
 		if (test_opt(sb, DATA_FLAGS) == EXT4_MOUNT_JOURNAL_DATA)
 			descr = " journalled data mode";
@@ -4436,6 +4462,11 @@ static int ext4_remount(struct super_block *sb, int *flags, char *data)
 		ext4_register_li_request(sb, first_not_zeroed);
 	}
 
+	if ((sb->s_flags & MS_RDONLY) || !test_opt2(sb, DISCARD_BG))
+		ext4_mb_stop_discard_thread(sb);
+	else
+		ext4_mb_start_discard_thread(sb);
+
 	ext4_setup_system_zone(sb);
 	if (sbi->s_journal == NULL)
 		ext4_commit_super(sb, 1);
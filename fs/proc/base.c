@@ -1818,7 +1818,7 @@ out:
 	return ~0U;
 }
 
-#define PROC_FDINFO_MAX 64
+#define PROC_FDINFO_MAX 192
 
 static int proc_fd_info(struct inode *inode, struct path *path, char *info)
 {
@@ -1854,9 +1854,17 @@ static int proc_fd_info(struct inode *inode, struct path *path, char *info)
 			if (info)
 				snprintf(info, PROC_FDINFO_MAX,
 					 "pos:\t%lli\n"
-					 "flags:\t0%o\n",
+					 "flags:\t0%o\n"
+					 "ra_window:\t%u\n"
+					 "ra_hits:\t%u\n"
+					 "ra_misses:\t%u\n"
+					 "ra_waits:\t%u\n",
 					 (long long) file->f_pos,
-					 f_flags);
+					 f_flags,
+					 file->f_ra.size,
+					 file->f_ra.hits,
+					 file->f_ra.misses,
+					 file->f_ra.waits);
 			spin_unlock(&files->file_lock);
 			put_files_struct(files);
 			return 0;
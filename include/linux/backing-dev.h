@@ -40,6 +40,7 @@ typedef int (congested_fn)(void *, int);
 enum bdi_stat_item {
 	BDI_RECLAIMABLE,
 	BDI_WRITEBACK,
+	BDI_WRITTEN,
 	NR_BDI_STAT_ITEMS
 };
 
@@ -71,6 +72,21 @@ struct backing_dev_info {
 
 	struct percpu_counter bdi_stat[NR_BDI_STAT_ITEMS];
 
+	/*
+	 * Write bandwidth estimation, in pages per second, updated at most
+	 * every BANDWIDTH_INTERVAL under bw_lock.
+	 */
+	unsigned long bw_time_stamp;	/* last time write bw is updated */
+	unsigned long written_stamp;	/* pages written at bw_time_stamp */
+	unsigned long write_bandwidth;	/* the estimated write bandwidth */
+	unsigned long avg_write_bandwidth; /* further smoothed write bw */
+	spinlock_t bw_lock;
+
+	/* balance_dirty_pages() pauses, for the debugfs stats only */
+	unsigned long dirty_pauses;
+	unsigned long dirty_pause_time;	/* in jiffies */
+	unsigned long dirty_pause_max;
+
 	struct prop_local_percpu completions;
 	int dirty_exceeded;
 
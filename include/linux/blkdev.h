@@ -123,7 +123,7 @@ struct request {
 	struct gendisk *rq_disk;
 	struct hd_struct *part;
 	unsigned long start_time;
-#ifdef CONFIG_BLK_CGROUP
+#if defined(CONFIG_BLK_CGROUP) || defined(CONFIG_BLK_DEV_LATENCY_STATS)
 	unsigned long long start_time_ns;
 	unsigned long long io_start_time_ns;    /* when passed to hardware */
 #endif
@@ -260,6 +260,19 @@ struct queue_limits {
 	unsigned char		discard_zeroes_data;
 };
 
+#ifdef CONFIG_BLK_DEV_LATENCY_STATS
+#define BLK_LAT_OPS		3	/* read, write, discard */
+#define BLK_LAT_BUCKETS		25	/* log2 usecs, the last 8s and more */
+#define BLK_LAT_DEPTHS		33	/* in flight 0..31, 32 and more */
+
+struct blk_latency_stats {
+	unsigned int		queue[BLK_LAT_OPS][BLK_LAT_BUCKETS];
+	unsigned int		device[BLK_LAT_OPS][BLK_LAT_BUCKETS];
+	u64			depth_ns[BLK_LAT_DEPTHS];
+	u64			depth_stamp;
+};
+#endif
+
 struct request_queue
 {
 	/*
@@ -383,6 +396,9 @@ struct request_queue
 	/* Throttle data */
 	struct throtl_data *td;
 #endif
+#ifdef CONFIG_BLK_DEV_LATENCY_STATS
+	struct blk_latency_stats lat_stats;
+#endif
 };
 
 #define QUEUE_FLAG_QUEUED	1	/* uses generic tag queueing */
@@ -1134,7 +1150,7 @@ static inline void put_dev_sector(Sector p)
 struct work_struct;
 int kblockd_schedule_work(struct request_queue *q, struct work_struct *work);
 
-#ifdef CONFIG_BLK_CGROUP
+#if defined(CONFIG_BLK_CGROUP) || defined(CONFIG_BLK_DEV_LATENCY_STATS)
 /*
  * This should not be using sched_clock(). A real patch is in progress
  * to fix this up, until that is in place we need to disable preemption
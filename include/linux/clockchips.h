@@ -54,6 +54,12 @@ enum clock_event_nofitiers {
 #define CLOCK_EVT_FEAT_C3STOP		0x000004
 #define CLOCK_EVT_FEAT_DUMMY		0x000008
 
+/*
+ * - Broadcast device whose interrupt can be routed to any cpu; the
+ *   broadcast code directs it to the cpu with the earliest event.
+ */
+#define CLOCK_EVT_FEAT_DYNIRQ		0x000020
+
 /**
  * struct clock_event_device - clock event device descriptor
  * @event_handler:	Assigned by the framework to be called by the low
@@ -153,8 +159,10 @@ clockevents_calc_mult_shift(struct clock_event_device *ce, u32 freq, u32 minsec)
 
 #if defined(CONFIG_GENERIC_CLOCKEVENTS_BROADCAST) && defined(CONFIG_TICK_ONESHOT)
 extern int tick_check_broadcast_pending(void);
+extern void tick_broadcast_set_slack(u64 slack_ns);
 #else
 static inline int tick_check_broadcast_pending(void) { return 0; }
+static inline void tick_broadcast_set_slack(u64 slack_ns) { }
 #endif
 
 #ifdef CONFIG_GENERIC_CLOCKEVENTS
@@ -158,6 +158,10 @@ extern struct klist *bus_get_device_klist(struct bus_type *bus);
  * @owner:	The module owner.
  * @mod_name:	Used for built-in modules.
  * @suppress_bind_attrs: Disables bind/unbind via sysfs.
+ * @async_probe: Probe devices present at boot from an async thread.
+ * @probe_after: NULL-terminated list of drivers on the same bus whose
+ *		pending asynchronous probes must finish before this driver
+ *		probes a device.
  * @of_match_table: The open firmware table.
  * @probe:	Called to query the existence of a specific device,
  *		whether this driver can work with it, and bind the driver
@@ -190,6 +194,9 @@ struct device_driver {
 	const char		*mod_name;	/* used for built-in modules */
 
 	bool suppress_bind_attrs;	/* disables bind/unbind via sysfs */
+	bool async_probe;		/* probe in parallel during boot */
+
+	const char * const *probe_after;
 
 	const struct of_device_id	*of_match_table;
 
@@ -208,6 +215,12 @@ struct device_driver {
 
 extern int __must_check driver_register(struct device_driver *drv);
 extern void driver_unregister(struct device_driver *drv);
+extern void wait_for_driver_probe(struct device_driver *drv);
+#ifdef CONFIG_ASYNC_DEVICE_PROBE
+extern void driver_async_probe_default(const char *drivers);
+#else
+static inline void driver_async_probe_default(const char *drivers) {}
+#endif
 
 extern struct device_driver *get_driver(struct device_driver *drv);
 extern void put_driver(struct device_driver *drv);
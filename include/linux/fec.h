@@ -21,6 +21,8 @@ struct fec_platform_data {
 	int (*power_hibernate) (struct phy_device *);
 	phy_interface_t phy;
 	unsigned char mac[ETH_ALEN];
+	/* cap on the PM QoS CPU DMA latency while up, in us; 0 for none */
+	s32 cpu_dma_latency;
 #ifdef CONFIG_MX6_ENET_IRQ_TO_GPIO
 	unsigned int gpio_irq;
 #endif
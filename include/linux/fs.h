@@ -920,6 +920,15 @@ struct file_ra_state {
 	unsigned int ra_pages;		/* Maximum readahead window */
 	unsigned int mmap_miss;		/* Cache miss stat for mmap accesses */
 	loff_t prev_pos;		/* Cache last read() position */
+
+	unsigned long stamp;		/* jiffies when the window was pushed */
+	unsigned int boost;		/* window may grow to ra_pages << boost */
+	unsigned int stride;		/* between the last two random reads */
+	pgoff_t stride_prev;		/* offset of the last random read */
+
+	unsigned int hits;		/* read() found the page uptodate */
+	unsigned int misses;		/* read() found no page */
+	unsigned int waits;		/* read() waited for readahead I/O */
 };
 
 /*
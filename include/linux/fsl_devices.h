@@ -19,6 +19,7 @@
 
 #include <linux/types.h>
 #include <linux/cdev.h>
+#include <linux/pm_qos_params.h>
 
 /*
  * Some conventions on how we handle peripherals on Freescale chips
@@ -147,6 +148,10 @@ struct fsl_usb2_platform_data {
 	u32		pmflags;	/* PM from otg or system */
 	spinlock_t lock;
 
+	/* PM QoS of the host controller while it is not suspended */
+	struct pm_qos_request_list pm_qos_lat;
+	struct pm_qos_request_list pm_qos_bw;
+
 	void __iomem *charger_base_addr; /* used for i.mx6 usb charger detect */
 
 	/* register save area for suspend/resume */
@@ -0,0 +1,36 @@
+#ifndef __LZ4_H__
+#define __LZ4_H__
+/*
+ * LZ4 Kernel Interface
+ *
+ * LZ4 is an LZ77 type compressor with a fixed, byte-oriented encoding and
+ * no entropy coder.  It compresses worse than gzip but decompresses several
+ * times faster, which makes it a good fit for boot images.
+ *
+ * The format is described at http://code.google.com/p/lz4/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+/* Worst case size of the compressed form of isize bytes */
+#define lz4_compressbound(isize)	((isize) + ((isize) / 255) + 16)
+
+/*
+ * lz4_decompress_unknownoutputsize()
+ *	src	: source address of the compressed data
+ *	src_len	: size of the compressed data, all of which must be one
+ *		  or more complete LZ4 sequences
+ *	dest	: output buffer address of the decompressed data
+ *	dest_len: is the size of the destination buffer
+ *		  (which must be already allocated)
+ *	return  : Success if return 0
+ *		  Error if return (< 0)
+ *	note :  Destination buffer must be already allocated.
+ *		On success *dest_len is updated to the number of bytes
+ *		written.  Never reads or writes outside the given buffers.
+ */
+int lz4_decompress_unknownoutputsize(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len);
+#endif
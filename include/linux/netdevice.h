@@ -1740,6 +1740,8 @@ struct softnet_data {
 	unsigned int		time_squeeze;
 	unsigned int		cpu_collision;
 	unsigned int		received_rps;
+	unsigned int		steered_rps;	/* queued to other CPUs */
+	u64			net_rx_time;	/* ns in net_rx_action() */
 
 #ifdef CONFIG_RPS
 	struct softnet_data	*rps_ipi_list;
@@ -90,7 +90,20 @@ extern struct tick_device *tick_get_broadcast_device(void);
 extern struct cpumask *tick_get_broadcast_mask(void);
 
 #  ifdef CONFIG_TICK_ONESHOT
+/**
+ * struct tick_broadcast_stats - per cpu oneshot broadcast statistics
+ * @enter:	times the cpu handed its local timer to the broadcast device
+ * @wakeups:	times the broadcast device woke the cpu up
+ * @coalesced:	wakeups brought forward to share another cpu's interrupt
+ */
+struct tick_broadcast_stats {
+	unsigned long		enter;
+	unsigned long		wakeups;
+	unsigned long		coalesced;
+};
+
 extern struct cpumask *tick_get_broadcast_oneshot_mask(void);
+extern struct tick_broadcast_stats *tick_get_broadcast_stats(int cpu);
 #  endif
 
 # endif /* BROADCAST */
@@ -233,6 +233,19 @@ XZ_EXTERN void xz_dec_reset(struct xz_dec *s);
  */
 XZ_EXTERN void xz_dec_end(struct xz_dec *s);
 
+#ifdef CONFIG_XZ_DEC_BENCH
+/**
+ * xz_dec_set_ref() - Select the reference LZMA2 decoding loops
+ * @s:          Decoder state allocated using xz_dec_init()
+ * @ref:        Use the plain literal decoder and match copy of the
+ *              decoder built without CONFIG_XZ_DEC_FAST
+ *
+ * Only the given decoder state is affected. This exists so that
+ * xz_dec_test can compare the speed of the two loops in one run.
+ */
+XZ_EXTERN void xz_dec_set_ref(struct xz_dec *s, bool ref);
+#endif
+
 /*
  * Standalone build (userspace build or in-kernel build for boot time use)
  * needs a CRC32 implementation. For normal in-kernel use, kernel's own
@@ -708,4 +708,9 @@ extern int zlib_inflateInit2(z_streamp strm, int  windowBits);
  * return len or negative error code. */
 extern int zlib_inflate_blob(void *dst, unsigned dst_sz, const void *src, unsigned src_sz);
 
+#ifdef CONFIG_ZLIB_INFLATE_BENCH
+/* zlib_inflate() with the byte-at-a-time fast loop, for benchmarking */
+extern int zlib_inflate_ref(z_streamp strm, int flush);
+#endif
+
 #endif /* _ZLIB_H */
@@ -60,6 +60,42 @@ typedef uLong (*check_func) (uLong check, const Byte *buf,
 #define DO8(buf,i)  DO4(buf,i); DO4(buf,i+4);
 #define DO16(buf)   DO8(buf,0); DO8(buf,8);
 
+/* Portable C implementation, also used for the tail left by the arch code */
+static inline uLong __zlib_adler32(uLong adler,
+				   const Byte *buf,
+				   uInt len)
+{
+    unsigned long s1 = adler & 0xffff;
+    unsigned long s2 = (adler >> 16) & 0xffff;
+    int k;
+
+    while (len > 0) {
+        k = len < NMAX ? len : NMAX;
+        len -= k;
+        while (k >= 16) {
+            DO16(buf);
+	    buf += 16;
+            k -= 16;
+        }
+        if (k != 0) do {
+            s1 += *buf++;
+	    s2 += s1;
+        } while (--k);
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+    return (s2 << 16) | s1;
+}
+
+#if defined(CONFIG_ZLIB_ADLER32_NEON) && !defined(STATIC)
+/* Folds whole 32 byte blocks into *adler, returns the bytes consumed */
+extern unsigned int zlib_adler32_neon(uLong *adler, const Byte *buf,
+				      uInt len);
+
+/* Below this the NEON state save/restore costs more than it gains */
+#define ZLIB_ADLER32_NEON_MIN	256
+#endif
+
 /* ========================================================================= */
 /*
      Update a running Adler-32 checksum with the bytes buf[0..len-1] and
@@ -79,28 +115,17 @@ static inline uLong zlib_adler32(uLong adler,
 				 const Byte *buf,
 				 uInt len)
 {
-    unsigned long s1 = adler & 0xffff;
-    unsigned long s2 = (adler >> 16) & 0xffff;
-    int k;
-
     if (buf == NULL) return 1L;
 
-    while (len > 0) {
-        k = len < NMAX ? len : NMAX;
-        len -= k;
-        while (k >= 16) {
-            DO16(buf);
-	    buf += 16;
-            k -= 16;
-        }
-        if (k != 0) do {
-            s1 += *buf++;
-	    s2 += s1;
-        } while (--k);
-        s1 %= BASE;
-        s2 %= BASE;
+#if defined(CONFIG_ZLIB_ADLER32_NEON) && !defined(STATIC)
+    if (len >= ZLIB_ADLER32_NEON_MIN) {
+        uInt done = zlib_adler32_neon(&adler, buf, len);
+
+        buf += done;
+        len -= done;
     }
-    return (s2 << 16) | s1;
+#endif
+    return __zlib_adler32(adler, buf, len);
 }
 
 #endif /* _Z_UTIL_H */
@@ -13,6 +13,7 @@
  * latency: usec
  * timeout: usec <-- currently not used.
  * throughput: kbs (kilo byte / sec)
+ * bandwidth: kbs (kilo byte / sec), summed over all requests
  *
  * There are lists of pm_qos_objects each one wrapping requests, notifiers
  *
@@ -51,7 +52,8 @@
  */
 enum pm_qos_type {
 	PM_QOS_MAX,		/* return the largest value */
-	PM_QOS_MIN		/* return the smallest value */
+	PM_QOS_MIN,		/* return the smallest value */
+	PM_QOS_SUM		/* return the sum of all values */
 };
 
 /*
@@ -104,11 +106,23 @@ static struct pm_qos_object network_throughput_pm_qos = {
 };
 
 
+static BLOCKING_NOTIFIER_HEAD(bus_bandwidth_notifier);
+static struct pm_qos_object bus_bandwidth_pm_qos = {
+	.requests = PLIST_HEAD_INIT(bus_bandwidth_pm_qos.requests),
+	.notifiers = &bus_bandwidth_notifier,
+	.name = "bus_bandwidth",
+	.target_value = PM_QOS_BUS_BANDWIDTH_DEFAULT_VALUE,
+	.default_value = PM_QOS_BUS_BANDWIDTH_DEFAULT_VALUE,
+	.type = PM_QOS_SUM,
+};
+
+
 static struct pm_qos_object *pm_qos_array[] = {
 	&null_pm_qos,
 	&cpu_dma_pm_qos,
 	&network_lat_pm_qos,
-	&network_throughput_pm_qos
+	&network_throughput_pm_qos,
+	&bus_bandwidth_pm_qos
 };
 
 static ssize_t pm_qos_power_write(struct file *filp, const char __user *buf,
@@ -129,6 +143,9 @@ static const struct file_operations pm_qos_power_fops = {
 /* unlocked internal variant */
 static inline int pm_qos_get_value(struct pm_qos_object *o)
 {
+	struct plist_node *node;
+	int total = 0;
+
 	if (plist_head_empty(&o->requests))
 		return o->default_value;
 
@@ -139,6 +156,11 @@ static inline int pm_qos_get_value(struct pm_qos_object *o)
 	case PM_QOS_MAX:
 		return plist_last(&o->requests)->prio;
 
+	case PM_QOS_SUM:
+		plist_for_each(node, &o->requests)
+			total += node->prio;
+		return total;
+
 	default:
 		/* runtime check for not using enum */
 		BUG();
@@ -471,9 +493,14 @@ static int __init pm_qos_power_init(void)
 		return ret;
 	}
 	ret = register_pm_qos_misc(&network_throughput_pm_qos);
-	if (ret < 0)
+	if (ret < 0) {
 		printk(KERN_ERR
 			"pm_qos_param: network_throughput setup failed\n");
+		return ret;
+	}
+	ret = register_pm_qos_misc(&bus_bandwidth_pm_qos);
+	if (ret < 0)
+		printk(KERN_ERR "pm_qos_param: bus_bandwidth setup failed\n");
 
 	return ret;
 }
@@ -329,6 +329,13 @@ device_suspend_time_threshold_store(struct kobject *kobj,
 	return -EINVAL;
 }
 power_attr(device_suspend_time_threshold);
+
+static int __init device_suspend_time_threshold_setup(char *str)
+{
+	device_suspend_time_threshold = simple_strtol(str, NULL, 0);
+	return 1;
+}
+__setup("suspend_time_threshold=", device_suspend_time_threshold_setup);
 #endif
 
 static struct attribute * g[] = {
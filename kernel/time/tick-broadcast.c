@@ -362,6 +362,13 @@ int tick_resume_broadcast(void)
 static DECLARE_BITMAP(tick_broadcast_oneshot_mask, NR_CPUS);
 static DECLARE_BITMAP(tick_broadcast_pending, NR_CPUS);
 static DECLARE_BITMAP(tick_force_broadcast_mask, NR_CPUS);
+static DEFINE_PER_CPU(struct tick_broadcast_stats, tick_broadcast_stats);
+
+/*
+ * Sleeping cpus whose next event lies within this window are woken
+ * together with the ones which expired, see tick_broadcast_set_slack().
+ */
+static u64 tick_broadcast_slack;
 
 /*
  * Exposed for debugging: see timer_list.c
@@ -371,11 +378,57 @@ struct cpumask *tick_get_broadcast_oneshot_mask(void)
 	return to_cpumask(tick_broadcast_oneshot_mask);
 }
 
-static int tick_broadcast_set_event(ktime_t expires, int force)
+struct tick_broadcast_stats *tick_get_broadcast_stats(int cpu)
+{
+	return &per_cpu(tick_broadcast_stats, cpu);
+}
+
+/**
+ * tick_broadcast_set_slack - set the broadcast wakeup window
+ * @slack_ns:	window in nanoseconds
+ *
+ * A cpu which left its local timer to the broadcast device needs the
+ * exit latency of its idle state to become operational again.  Waking
+ * it up to @slack_ns before its event costs no extra latency when
+ * @slack_ns does not exceed that exit latency, and it saves a separate
+ * broadcast interrupt when the events of several cpus are close.
+ */
+void tick_broadcast_set_slack(u64 slack_ns)
+{
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&tick_broadcast_lock, flags);
+	tick_broadcast_slack = slack_ns;
+	raw_spin_unlock_irqrestore(&tick_broadcast_lock, flags);
+}
+
+/*
+ * Route the broadcast interrupt to the cpu with the earliest event, so
+ * that cpu handles its own event and no other cpu is woken up for it.
+ */
+static void tick_broadcast_set_affinity(struct clock_event_device *bc,
+					int cpu)
+{
+	if (!(bc->features & CLOCK_EVT_FEAT_DYNIRQ))
+		return;
+
+	if (cpumask_equal(bc->cpumask, cpumask_of(cpu)))
+		return;
+
+	bc->cpumask = cpumask_of(cpu);
+	irq_set_affinity(bc->irq, bc->cpumask);
+}
+
+static int tick_broadcast_set_event(ktime_t expires, int cpu, int force)
 {
 	struct clock_event_device *bc = tick_broadcast_device.evtdev;
+	int ret;
+
+	ret = tick_dev_program_event(bc, expires, force);
+	if (!ret)
+		tick_broadcast_set_affinity(bc, cpu);
 
-	return tick_dev_program_event(bc, expires, force);
+	return ret;
 }
 
 /*
@@ -413,7 +466,7 @@ static void tick_handle_oneshot_broadcast(struct clock_event_device *dev)
 {
 	struct tick_device *td;
 	ktime_t now, next_event;
-	int cpu;
+	int cpu, next_cpu = 0;
 
 	raw_spin_lock(&tick_broadcast_lock);
 again:
@@ -421,10 +474,14 @@ again:
 	next_event.tv64 = KTIME_MAX;
 	cpumask_clear(to_cpumask(tmpmask));
 	now = ktime_get();
-	/* Find all expired events */
+	/* Find all expired events and the ones due within the slack */
 	for_each_cpu(cpu, tick_get_broadcast_oneshot_mask()) {
 		td = &per_cpu(tick_cpu_device, cpu);
-		if (td->evtdev->next_event.tv64 <= now.tv64) {
+		if (td->evtdev->next_event.tv64 <=
+		    now.tv64 + tick_broadcast_slack) {
+			if (td->evtdev->next_event.tv64 > now.tv64)
+				per_cpu(tick_broadcast_stats, cpu).coalesced++;
+			per_cpu(tick_broadcast_stats, cpu).wakeups++;
 			cpumask_set_cpu(cpu, to_cpumask(tmpmask));
 			/*
 			 * Mark the remote cpu in the pending mask, so
@@ -432,8 +489,10 @@ again:
 			 * timer in tick_broadcast_oneshot_control().
 			 */
 			set_bit(cpu, tick_broadcast_pending);
-		} else if (td->evtdev->next_event.tv64 < next_event.tv64)
+		} else if (td->evtdev->next_event.tv64 < next_event.tv64) {
 			next_event.tv64 = td->evtdev->next_event.tv64;
+			next_cpu = cpu;
+		}
 	}
 
 	/* Take care of enforced broadcast requests */
@@ -462,7 +521,7 @@ again:
 		 * Rearm the broadcast device. If event expired,
 		 * repeat the above
 		 */
-		if (tick_broadcast_set_event(next_event, 0))
+		if (tick_broadcast_set_event(next_event, next_cpu, 0))
 			goto again;
 	}
 	raw_spin_unlock(&tick_broadcast_lock);
@@ -506,9 +565,10 @@ void tick_broadcast_oneshot_control(unsigned long reason)
 		WARN_ON_ONCE(test_bit(cpu, tick_force_broadcast_mask));
 		if (!cpumask_test_cpu(cpu, tick_get_broadcast_oneshot_mask())) {
 			cpumask_set_cpu(cpu, tick_get_broadcast_oneshot_mask());
+			per_cpu(tick_broadcast_stats, cpu).enter++;
 			clockevents_set_mode(dev, CLOCK_EVT_MODE_SHUTDOWN);
 			if (dev->next_event.tv64 < bc->next_event.tv64)
-				tick_broadcast_set_event(dev->next_event, 1);
+				tick_broadcast_set_event(dev->next_event, cpu, 1);
 		}
 	} else {
 		if (cpumask_test_cpu(cpu, tick_get_broadcast_oneshot_mask())) {
@@ -630,7 +690,7 @@ void tick_broadcast_setup_oneshot(struct clock_event_device *bc)
 		if (was_periodic && !cpumask_empty(to_cpumask(tmpmask))) {
 			tick_broadcast_init_next_event(to_cpumask(tmpmask),
 						       tick_next_period);
-			tick_broadcast_set_event(tick_next_period, 1);
+			tick_broadcast_set_event(tick_next_period, cpu, 1);
 		} else
 			bc->next_event.tv64 = KTIME_MAX;
 	} else {
@@ -243,6 +243,13 @@ static void timer_list_show_tickdevices(struct seq_file *m)
 #ifdef CONFIG_TICK_ONESHOT
 	SEQ_printf(m, "tick_broadcast_oneshot_mask: %08lx\n",
 		   cpumask_bits(tick_get_broadcast_oneshot_mask())[0]);
+	for_each_online_cpu(cpu) {
+		struct tick_broadcast_stats *st = tick_get_broadcast_stats(cpu);
+
+		SEQ_printf(m, "tick_broadcast cpu#%d: enter %lu, wakeups %lu, "
+			   "coalesced %lu\n", cpu, st->enter, st->wakeups,
+			   st->coalesced);
+	}
 #endif
 	SEQ_printf(m, "\n");
 #endif
@@ -259,7 +266,7 @@ static int timer_list_show(struct seq_file *m, void *v)
 	u64 now = ktime_to_ns(ktime_get());
 	int cpu;
 
-	SEQ_printf(m, "Timer List Version: v0.6\n");
+	SEQ_printf(m, "Timer List Version: v0.7\n");
 	SEQ_printf(m, "HRTIMER_MAX_CLOCK_BASES: %d\n", HRTIMER_MAX_CLOCK_BASES);
 	SEQ_printf(m, "now at %Ld nsecs\n", (unsigned long long)now);
 
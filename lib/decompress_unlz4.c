@@ -0,0 +1,177 @@
+/*
+ * LZ4 decompressor for the Linux kernel.
+ *
+ * Handles the LZ4 "legacy" container written by "lz4 -l": a four byte
+ * magic number followed by blocks of at most 8 MiB of uncompressed data,
+ * each stored as a 32-bit little-endian compressed size and an LZ4 block.
+ * Concatenated streams repeat the magic number, which is skipped.  The
+ * format has no end marker, so decompression stops at the end of the
+ * input, at a zero block size (padding) or when fewer bytes remain than
+ * a block size field plus a block (the size appended to kernel images).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifdef STATIC
+#include "lz4/lz4_decompress.c"
+#else
+#include <linux/decompress/unlz4.h>
+#endif
+
+#include <linux/types.h>
+#include <linux/lz4.h>
+#include <linux/decompress/mm.h>
+
+#include <linux/compiler.h>
+#include <asm/unaligned.h>
+
+#define LZ4_LEGACY_MAGIC	0x184C2102
+#define LZ4_BLOCK_SIZE		(8 << 20)
+
+STATIC inline int INIT unlz4(u8 *input, int in_len,
+				int (*fill) (void *, unsigned int),
+				int (*flush) (void *, unsigned int),
+				u8 *output, int *posp,
+				void (*error) (char *x))
+{
+	int ret = -1;
+	size_t chunksize = 0;
+	size_t dest_len;
+	u8 *inp;
+	u8 *inp_start;
+	u8 *outp;
+	int size = in_len;
+	int n;
+
+	if (output) {
+		outp = output;
+	} else if (!flush) {
+		error("NULL output pointer and no flush function provided");
+		goto exit_0;
+	} else {
+		outp = large_malloc(LZ4_BLOCK_SIZE);
+		if (!outp) {
+			error("Could not allocate output buffer");
+			goto exit_0;
+		}
+	}
+
+	if (input && fill) {
+		error("Both input pointer and fill function provided, don't know what to do");
+		goto exit_1;
+	} else if (input) {
+		inp = input;
+	} else if (!fill) {
+		error("NULL input pointer and missing fill function");
+		goto exit_1;
+	} else {
+		inp = large_malloc(lz4_compressbound(LZ4_BLOCK_SIZE));
+		if (!inp) {
+			error("Could not allocate input buffer");
+			goto exit_1;
+		}
+	}
+	inp_start = inp;
+
+	if (posp)
+		*posp = 0;
+
+	if (fill)
+		size = fill(inp, 4);
+
+	if (size < 4 || get_unaligned_le32(inp) != LZ4_LEGACY_MAGIC) {
+		error("invalid header");
+		goto exit_2;
+	}
+	if (!fill) {
+		inp += 4;
+		size -= 4;
+	}
+	if (posp)
+		*posp += 4;
+
+	for (;;) {
+		if (fill) {
+			size = fill(inp, 4);
+			if (size == 0)
+				break;
+		}
+		/* four bytes can't be a block: the appended image size */
+		if (size < 4 || (!fill && size == 4))
+			break;
+
+		chunksize = get_unaligned_le32(inp);
+		if (chunksize == LZ4_LEGACY_MAGIC) {
+			/* start of a concatenated stream */
+			if (!fill) {
+				inp += 4;
+				size -= 4;
+			}
+			if (posp)
+				*posp += 4;
+			continue;
+		}
+		if (chunksize == 0)
+			break;
+		if (chunksize > lz4_compressbound(LZ4_BLOCK_SIZE)) {
+			/* the appended image size at the end of a file */
+			if (fill && fill(inp, 1) == 0)
+				break;
+			error("chunk size too large");
+			goto exit_2;
+		}
+
+		if (fill) {
+			n = fill(inp, chunksize);
+			/* the appended image size at the end of a file */
+			if (n == 0)
+				break;
+			if (n < 0 || (size_t)n != chunksize) {
+				error("data corrupted");
+				goto exit_2;
+			}
+		} else {
+			if ((size_t)(size - 4) < chunksize) {
+				error("data corrupted");
+				goto exit_2;
+			}
+			inp += 4;
+			size -= 4;
+		}
+		if (posp)
+			*posp += 4;
+
+		dest_len = LZ4_BLOCK_SIZE;
+		if (lz4_decompress_unknownoutputsize(inp, chunksize, outp,
+						     &dest_len) < 0) {
+			error("Decoding failed");
+			goto exit_2;
+		}
+
+		if (flush && flush(outp, dest_len) != dest_len)
+			goto exit_2;
+		if (output)
+			outp += dest_len;
+		if (posp)
+			*posp += chunksize;
+
+		if (!fill) {
+			inp += chunksize;
+			size -= chunksize;
+		}
+	}
+
+	ret = 0;
+exit_2:
+	if (!input)
+		large_free(inp_start);
+exit_1:
+	if (!output)
+		large_free(outp);
+exit_0:
+	return ret;
+}
+
+#define decompress unlz4
@@ -0,0 +1,185 @@
+/*
+ * LZ4 Decompressor for Linux kernel
+ *
+ * Decodes the LZ4 block format: a series of sequences, each made of a
+ * token byte, a run of literals and a back reference.  The high nibble of
+ * the token is the literal length and the low nibble the match length
+ * minus four; a nibble of 15 is continued by extra length bytes, each 255
+ * meaning another byte follows.  The back reference is a 16-bit
+ * little-endian offset.  The last sequence of a block has no match.
+ *
+ * The decoder never reads past src + src_len nor writes past
+ * dest + *dest_len, whatever the input, so it can be used on untrusted
+ * data such as initramfs images.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef STATIC
+#include <linux/module.h>
+#include <linux/kernel.h>
+#endif
+
+#include <linux/types.h>
+#include <linux/lz4.h>
+#include <asm/unaligned.h>
+
+/*
+ * Literal runs and matches are copied eight bytes at a time, which may
+ * write up to seven bytes past the end of the run; this is only done when
+ * the output buffer has room for it.  On machines with cheap unaligned
+ * accesses a copy step is two word loads and stores.  Elsewhere, and in the
+ * pre-boot decompressor where the alignment trap may still be enabled, the
+ * words are put together from bytes by get_unaligned().
+ */
+#define COPYLENGTH	8
+
+#if !defined(STATIC) && \
+    (defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS) || \
+     (defined(CONFIG_ARM) && __LINUX_ARM_ARCH__ >= 6))
+struct lz4_una32 {
+	u32 x;
+} __attribute__((packed));
+
+#define LZ4_COPY4(d, s) \
+	(((struct lz4_una32 *)(d))->x = ((const struct lz4_una32 *)(s))->x)
+#else
+#define LZ4_COPY4(d, s) \
+	put_unaligned(get_unaligned((const u32 *)(s)), (u32 *)(d))
+#endif
+
+#define LZ4_COPY8(d, s)				\
+	do {					\
+		LZ4_COPY4(d, s);		\
+		LZ4_COPY4((d) + 4, (s) + 4);	\
+	} while (0)
+
+/* Copy at least len bytes from s to d in steps of COPYLENGTH */
+static inline void lz4_wildcopy(u8 *d, const u8 *s, size_t len)
+{
+	u8 *e = d + len;
+
+	do {
+		LZ4_COPY8(d, s);
+		d += COPYLENGTH;
+		s += COPYLENGTH;
+	} while (d < e);
+}
+
+/*
+ * Read the continuation bytes of a length nibble of 15.  Returns false if
+ * the input ends first or the length no longer fits in size_t.
+ */
+static inline bool lz4_read_length(const u8 **ipp, const u8 *iend,
+				   size_t *length)
+{
+	const u8 *ip = *ipp;
+	size_t len = *length;
+	unsigned int s;
+
+	do {
+		if (unlikely(ip >= iend))
+			return false;
+		s = *ip++;
+		len += s;
+		if (unlikely(len < s))
+			return false;
+	} while (s == 255);
+
+	*ipp = ip;
+	*length = len;
+	return true;
+}
+
+int lz4_decompress_unknownoutputsize(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len)
+{
+	const u8 *ip = src;
+	const u8 * const iend = src + src_len;
+	u8 *op = dest;
+	u8 * const oend = dest + *dest_len;
+	const u8 *match;
+	unsigned int token;
+	size_t length;
+	size_t offset;
+
+	if (unlikely(src_len == 0))
+		goto _output_error;
+
+	for (;;) {
+		/* literals */
+		if (unlikely(ip >= iend))
+			goto _output_error;
+		token = *ip++;
+		length = token >> 4;
+		if (length == 15 && !lz4_read_length(&ip, iend, &length))
+			goto _output_error;
+
+		if (unlikely(length > (size_t)(iend - ip) ||
+			     length > (size_t)(oend - op)))
+			goto _output_error;
+
+		if (length + COPYLENGTH <= (size_t)(oend - op) &&
+		    length + COPYLENGTH <= (size_t)(iend - ip)) {
+			lz4_wildcopy(op, ip, length);
+		} else {
+			/* close to the end of a buffer: copy exactly */
+			memcpy(op, ip, length);
+		}
+		ip += length;
+		op += length;
+
+		/* the last sequence of the block has literals only */
+		if (ip == iend)
+			break;
+
+		/* match */
+		if (unlikely(iend - ip < 2))
+			goto _output_error;
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (unlikely(offset == 0 || offset > (size_t)(op - dest)))
+			goto _output_error;
+		match = op - offset;
+
+		length = token & 15;
+		if (length == 15 && !lz4_read_length(&ip, iend, &length))
+			goto _output_error;
+		length += 4;
+		if (unlikely(length < 4 || length > (size_t)(oend - op)))
+			goto _output_error;
+
+		if (offset >= COPYLENGTH &&
+		    length + COPYLENGTH <= (size_t)(oend - op)) {
+			/*
+			 * The source of each eight byte step is at least
+			 * eight bytes behind it, so it has been written
+			 * already even though the ranges may overlap.
+			 */
+			lz4_wildcopy(op, match, length);
+			op += length;
+		} else {
+			/* short offsets replicate a pattern byte by byte */
+			u8 * const cpy = op + length;
+
+			do {
+				*op++ = *match++;
+			} while (op < cpy);
+		}
+	}
+
+	*dest_len = op - dest;
+	return 0;
+
+	/* malformed input or output buffer too small */
+_output_error:
+	return -1;
+}
+#ifndef STATIC
+EXPORT_SYMBOL_GPL(lz4_decompress_unknownoutputsize);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("LZ4 Decompressor");
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Test corpus shared by the compression self-tests.
+ *
+ * Literal noise mixed with short (up to 8 bytes back) and long distance
+ * repeats, compressing roughly like text or filesystem metadata.  The
+ * output depends only on the parameters, so data compressed offline from
+ * it can be checked byte for byte.
+ */
+#ifndef _LIB_TEST_CORPUS_H
+#define _LIB_TEST_CORPUS_H
+
+#include <linux/init.h>
+#include <linux/types.h>
+
+/*
+ * Fill @buf with @size bytes from @seed.  The first @prefix bytes are
+ * literals; repeats are @min_len to @min_len + @len_range - 1 bytes long.
+ */
+static void __init test_corpus_fill(u8 *buf, unsigned int size, u32 seed,
+				    unsigned int prefix, unsigned int min_len,
+				    unsigned int len_range)
+{
+	unsigned int i = 0;
+
+	while (i < size) {
+		unsigned int len, dist, kind;
+
+		seed = seed * 1103515245 + 12345;
+		kind = (seed >> 16) & 3;
+		if (kind == 0 || i < prefix) {
+			buf[i++] = 'a' + (seed >> 8) % 26;
+			continue;
+		}
+		len = min_len + (seed >> 4) % len_range;
+		dist = 1 + (kind == 1 ? (seed >> 10) % 8 : (seed >> 10) % i);
+		if (dist > i)
+			dist = i;
+		while (len-- && i < size) {
+			buf[i] = buf[i - dist];
+			i++;
+		}
+	}
+}
+
+#endif /* _LIB_TEST_CORPUS_H */
@@ -0,0 +1,249 @@
+/*
+ * Self-test and benchmark for the LZ4 decompressor.
+ *
+ * The test block below is an 8 KiB corpus, compressed with "lz4 -9".  The
+ * corpus is regenerated here with the same generator, so the decompressed
+ * data can be checked byte for byte.  Undersized output buffers and every
+ * truncation of the input must be rejected without touching memory outside
+ * the buffers.  Load the module to run the tests, unload it to run them
+ * again.
+ */
+#include <linux/hrtimer.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/lz4.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+
+#include "test-corpus.h"
+
+#define CORPUS_SIZE	8192
+
+static unsigned int iterations = 1000;
+module_param(iterations, uint, 0444);
+MODULE_PARM_DESC(iterations, "Number of decompressions timed");
+
+static const u8 test_lz4_block[] __initconst = {
+	0xff, 0x01, 0x76, 0x64, 0x61, 0x6b, 0x72, 0x6f, 0x61, 0x67, 0x6e, 0x77,
+	0x74, 0x6d, 0x79, 0x78, 0x6e, 0x73, 0x05, 0x00, 0x07, 0x0a, 0x06, 0x00,
+	0x0d, 0x2f, 0x00, 0x0f, 0x08, 0x00, 0x04, 0x0f, 0x07, 0x00, 0x06, 0x0c,
+	0x22, 0x00, 0x1b, 0x67, 0x5b, 0x00, 0x01, 0x0d, 0x00, 0x0f, 0x02, 0x00,
+	0x03, 0x07, 0x77, 0x00, 0x0f, 0x4c, 0x00, 0x09, 0x2f, 0x6b, 0x66, 0x04,
+	0x00, 0x08, 0x01, 0x28, 0x00, 0x0f, 0xdb, 0x00, 0x0a, 0x1e, 0x6f, 0x06,
+	0x01, 0x1f, 0x69, 0x21, 0x01, 0x0c, 0x0f, 0x05, 0x00, 0x00, 0x06, 0x07,
+	0x00, 0x0f, 0x3e, 0x00, 0x0b, 0x08, 0xcf, 0x00, 0x2f, 0x69, 0x64, 0x8e,
+	0x00, 0x00, 0x2e, 0x6f, 0x67, 0x36, 0x00, 0x0f, 0x1f, 0x00, 0x05, 0x0f,
+	0x87, 0x00, 0x09, 0x0f, 0xe8, 0x01, 0x04, 0x0e, 0x45, 0x01, 0x0e, 0xe5,
+	0x00, 0x0f, 0x9c, 0x00, 0x0d, 0x0e, 0x3f, 0x00, 0x0f, 0xeb, 0x00, 0x0a,
+	0x1f, 0x64, 0x05, 0x00, 0x0c, 0x04, 0x12, 0x02, 0x09, 0x41, 0x00, 0x2f,
+	0x72, 0x6f, 0xb3, 0x01, 0x04, 0x0f, 0x52, 0x00, 0x11, 0x00, 0x05, 0x00,
+	0x12, 0x70, 0x1c, 0x02, 0x0f, 0xe3, 0x01, 0x09, 0x00, 0x28, 0x00, 0x0f,
+	0x08, 0x00, 0x02, 0x05, 0xf2, 0x00, 0x0f, 0x01, 0x00, 0x01, 0x0c, 0x8b,
+	0x02, 0x0e, 0x03, 0x00, 0x0d, 0x2c, 0x01, 0x05, 0x07, 0x00, 0x0f, 0x01,
+	0x00, 0x07, 0x0f, 0xaf, 0x02, 0x0f, 0x0d, 0x06, 0x00, 0x0f, 0x01, 0x00,
+	0x1f, 0x3f, 0x79, 0x77, 0x74, 0x01, 0x00, 0x20, 0x04, 0x90, 0x03, 0x0f,
+	0xbc, 0x01, 0x0e, 0x01, 0x07, 0x00, 0x1a, 0x6a, 0xaa, 0x01, 0x0b, 0x01,
+	0x00, 0x00, 0x1f, 0x01, 0x0f, 0x06, 0x00, 0x00, 0x31, 0x7a, 0x66, 0x71,
+	0xa1, 0x00, 0x1e, 0x7a, 0x19, 0x04, 0x02, 0x38, 0x00, 0x07, 0x10, 0x00,
+	0x03, 0x04, 0x00, 0x0f, 0x9f, 0x00, 0x0b, 0x0f, 0x48, 0x00, 0x0b, 0x0c,
+	0x04, 0x00, 0x0f, 0x07, 0x00, 0x06, 0x0f, 0x01, 0x00, 0x22, 0x1f, 0x61,
+	0xcc, 0x03, 0x05, 0x0f, 0x25, 0x03, 0x04, 0x0b, 0x01, 0x00, 0x2e, 0x6f,
+	0x6a, 0x05, 0x00, 0x0f, 0xcd, 0x01, 0x01, 0x3f, 0x73, 0x76, 0x6f, 0x01,
+	0x00, 0x02, 0x2f, 0x62, 0x78, 0x08, 0x00, 0x06, 0x03, 0x0d, 0x01, 0x0f,
+	0xda, 0x04, 0x09, 0x2f, 0x6d, 0x71, 0x2c, 0x02, 0x08, 0x1e, 0x78, 0x04,
+	0x00, 0x0f, 0x3c, 0x05, 0x05, 0x25, 0x70, 0x73, 0xc4, 0x03, 0x0f, 0x01,
+	0x00, 0x0d, 0x1f, 0x6b, 0x06, 0x00, 0x04, 0x0f, 0xbe, 0x04, 0x02, 0x00,
+	0x5c, 0x01, 0x1e, 0x67, 0xe3, 0x05, 0x17, 0x78, 0x66, 0x01, 0x0d, 0xe0,
+	0x04, 0x0f, 0x0a, 0x03, 0x01, 0x0e, 0x06, 0x04, 0x08, 0x93, 0x02, 0x0d,
+	0x01, 0x00, 0x0f, 0x28, 0x04, 0x0b, 0x07, 0x76, 0x05, 0x0b, 0xcd, 0x06,
+	0x0e, 0xde, 0x06, 0x2b, 0x6e, 0x6b, 0x2a, 0x01, 0x0e, 0xae, 0x01, 0x0f,
+	0x67, 0x05, 0x02, 0x0e, 0x7d, 0x04, 0x07, 0x06, 0x00, 0x0f, 0x03, 0x00,
+	0x0a, 0x2f, 0x71, 0x6a, 0x03, 0x00, 0x0c, 0x39, 0x73, 0x6d, 0x79, 0x69,
+	0x01, 0x1f, 0x6b, 0xa1, 0x07, 0x08, 0x0a, 0x76, 0x03, 0x0f, 0x01, 0x00,
+	0x01, 0x0a, 0x69, 0x01, 0x10, 0x6c, 0x49, 0x00, 0x1f, 0x71, 0x3d, 0x01,
+	0x06, 0x0f, 0x05, 0x00, 0x0a, 0x4f, 0x6e, 0x6c, 0x6b, 0x78, 0x07, 0x00,
+	0x08, 0x15, 0x6b, 0xb2, 0x00, 0x0f, 0x5a, 0x08, 0x07, 0x5f, 0x71, 0x79,
+	0x70, 0x73, 0x6d, 0xca, 0x04, 0x12, 0x0b, 0x05, 0x00, 0x0a, 0xf9, 0x02,
+	0x10, 0x67, 0x01, 0x00, 0x01, 0x78, 0x00, 0x18, 0x74, 0x08, 0x00, 0x1f,
+	0x73, 0x05, 0x00, 0x07, 0x14, 0x6b, 0x8d, 0x07, 0x0d, 0x02, 0x00, 0x0f,
+	0x01, 0x00, 0x2b, 0x0a, 0xdc, 0x01, 0x0a, 0xad, 0x02, 0x0f, 0xaf, 0x01,
+	0x0a, 0x0f, 0xd1, 0x05, 0x04, 0x0f, 0x73, 0x00, 0x10, 0x0f, 0x21, 0x0a,
+	0x09, 0x2d, 0x72, 0x77, 0x02, 0x00, 0x0f, 0x83, 0x04, 0x07, 0x1f, 0x63,
+	0x1f, 0x00, 0x09, 0x03, 0x38, 0x02, 0x0c, 0xdb, 0x06, 0x0f, 0x1a, 0x01,
+	0x17, 0x1e, 0x66, 0x29, 0x0a, 0x07, 0x03, 0x00, 0x0f, 0x38, 0x05, 0x07,
+	0x07, 0x99, 0x07, 0x06, 0x2e, 0x08, 0x4f, 0x70, 0x67, 0x61, 0x75, 0xbb,
+	0x09, 0x08, 0x0e, 0x48, 0x0a, 0x0f, 0x74, 0x07, 0x07, 0x04, 0xbf, 0x09,
+	0x0f, 0x86, 0x09, 0x05, 0x2f, 0x75, 0x6a, 0x32, 0x02, 0x0a, 0x0f, 0x5f,
+	0x00, 0x06, 0x0b, 0x76, 0x03, 0x0f, 0x94, 0x0b, 0x02, 0x0f, 0x03, 0x00,
+	0x0a, 0x0f, 0x30, 0x07, 0x0a, 0x1f, 0x63, 0x70, 0x07, 0x06, 0x00, 0x01,
+	0x00, 0x06, 0xec, 0x06, 0x0d, 0x74, 0x05, 0x1f, 0x6c, 0x03, 0x00, 0x06,
+	0x1f, 0x74, 0x01, 0x00, 0x26, 0x10, 0x76, 0x04, 0x00, 0x15, 0x65, 0x01,
+	0x00, 0x01, 0x7a, 0x00, 0x18, 0x6a, 0x9d, 0x01, 0x17, 0x78, 0xd8, 0x07,
+	0x2f, 0x6e, 0x6e, 0x08, 0x00, 0x0c, 0x08, 0x5d, 0x05, 0x06, 0xb0, 0x0b,
+	0x0f, 0x0c, 0x05, 0x0a, 0x09, 0x08, 0x00, 0x0f, 0x01, 0x00, 0x08, 0x1f,
+	0x64, 0x01, 0x00, 0x0a, 0x02, 0xe8, 0x09, 0x27, 0x73, 0x73, 0xc1, 0x03,
+	0x1d, 0x74, 0x03, 0x00, 0x1f, 0x6c, 0x08, 0x00, 0x0c, 0x1f, 0x6e, 0x05,
+	0x00, 0x0c, 0x0f, 0xdd, 0x07, 0x06, 0x07, 0x50, 0x01, 0x02, 0x10, 0x00,
+	0x0f, 0x06, 0x00, 0x09, 0x1f, 0x74, 0xe0, 0x0b, 0x07, 0x02, 0xf5, 0x02,
+	0x1f, 0x72, 0x38, 0x00, 0x00, 0x02, 0x01, 0x04, 0x23, 0x61, 0x6a, 0xaa,
+	0x04, 0x04, 0x34, 0x00, 0x1a, 0x66, 0x9d, 0x00, 0x0f, 0xac, 0x06, 0x0a,
+	0x0f, 0xd4, 0x03, 0x02, 0x19, 0x70, 0xeb, 0x01, 0x0f, 0xe8, 0x05, 0x07,
+	0x2f, 0x6c, 0x6e, 0xc5, 0x01, 0x07, 0x1f, 0x6a, 0x07, 0x00, 0x06, 0x01,
+	0xb5, 0x0b, 0x1f, 0x61, 0xda, 0x02, 0x07, 0x06, 0x04, 0x03, 0x15, 0x72,
+	0x63, 0x02, 0x07, 0x05, 0x00, 0x07, 0x8b, 0x08, 0x0f, 0x03, 0x08, 0x00,
+	0x03, 0xb1, 0x07, 0x06, 0xd5, 0x0b, 0x0f, 0x6f, 0x03, 0x0b, 0x0f, 0x85,
+	0x06, 0x09, 0x00, 0x95, 0x00, 0x0a, 0x07, 0x00, 0x0f, 0x71, 0x09, 0x25,
+	0x0c, 0x01, 0x00, 0x4f, 0x6a, 0x7a, 0x6b, 0x67, 0x04, 0x00, 0x0b, 0x0f,
+	0x78, 0x0c, 0x0a, 0x0b, 0x13, 0x06, 0x0f, 0x08, 0x00, 0x08, 0x1f, 0x74,
+	0x03, 0x00, 0x04, 0x02, 0xf7, 0x0c, 0x0f, 0xab, 0x09, 0x03, 0x03, 0x0d,
+	0x01, 0x1f, 0x65, 0x05, 0x00, 0x00, 0x0f, 0x2d, 0x0b, 0x03, 0x0e, 0x04,
+	0x00, 0x0f, 0x28, 0x04, 0x07, 0x04, 0xe8, 0x01, 0x0f, 0x87, 0x06, 0x01,
+	0x0f, 0xc7, 0x01, 0x07, 0x06, 0xc6, 0x06, 0x1f, 0x64, 0xb5, 0x04, 0x08,
+	0x1f, 0x6f, 0x03, 0x00, 0x07, 0x0f, 0x07, 0x00, 0x01, 0x0f, 0x7e, 0x0e,
+	0x0a, 0x0c, 0xb7, 0x07, 0x09, 0xaa, 0x0f, 0x06, 0x40, 0x02, 0x0f, 0x41,
+	0x01, 0x09, 0x0a, 0x01, 0x00, 0x0f, 0x52, 0x11, 0x01, 0x04, 0x7e, 0x00,
+	0x0f, 0x05, 0x08, 0x04, 0x0d, 0x07, 0x00, 0x0f, 0xad, 0x07, 0x06, 0x0a,
+	0x5f, 0x0b, 0x1f, 0x79, 0x02, 0x00, 0x02, 0x1f, 0x76, 0x30, 0x07, 0x08,
+	0x0e, 0xda, 0x10, 0x07, 0x00, 0x09, 0x0f, 0x4b, 0x12, 0x01, 0x0f, 0x70,
+	0x00, 0x10, 0x09, 0x02, 0x00, 0x2e, 0x77, 0x73, 0xce, 0x09, 0x0c, 0xda,
+	0x08, 0x0c, 0x9e, 0x01, 0x0f, 0x05, 0x00, 0x0b, 0x0f, 0x75, 0x03, 0x02,
+	0x0f, 0xd7, 0x03, 0x04, 0x2f, 0x71, 0x6e, 0x68, 0x0e, 0x08, 0x15, 0x72,
+	0x99, 0x01, 0x0f, 0xa5, 0x0e, 0x05, 0x2f, 0x69, 0x6d, 0xf5, 0x01, 0x04,
+	0x09, 0xed, 0x02, 0x01, 0xb8, 0x00, 0x1f, 0x64, 0x09, 0x0a, 0x0c, 0x0d,
+	0xea, 0x0f, 0x0b, 0x83, 0x05, 0x3f, 0x61, 0x79, 0x77, 0x05, 0x00, 0x11,
+	0x3f, 0x71, 0x72, 0x70, 0xbe, 0x07, 0x0c, 0x1f, 0x6c, 0x54, 0x09, 0x00,
+	0x07, 0x27, 0x01, 0x0f, 0x2c, 0x05, 0x01, 0x0f, 0x5f, 0x12, 0x0c, 0x0f,
+	0x02, 0x00, 0x17, 0x1b, 0x62, 0x04, 0x00, 0x0d, 0x30, 0x14, 0x1e, 0x78,
+	0x62, 0x08, 0x0f, 0x01, 0x00, 0x02, 0x07, 0xf0, 0x01, 0x27, 0x6d, 0x73,
+	0x84, 0x02, 0x00, 0x80, 0x02, 0x04, 0xfa, 0x0b, 0x0f, 0x07, 0x00, 0x05,
+	0x0e, 0xbb, 0x0b, 0x03, 0x45, 0x0a, 0x0f, 0x39, 0x0b, 0x0b, 0x0e, 0xd0,
+	0x07, 0x0f, 0x09, 0x01, 0x03, 0x0f, 0xa5, 0x04, 0x0c, 0x04, 0x2f, 0x05,
+	0x1f, 0x63, 0x1f, 0x01, 0x07, 0x09, 0x73, 0x0e, 0x03, 0x86, 0x0f, 0x1b,
+	0x79, 0x06, 0x12, 0x07, 0x01, 0x00, 0x18, 0x7a, 0x83, 0x00, 0x1f, 0x74,
+	0x01, 0x00, 0x2e, 0x04, 0x1b, 0x0f, 0x1b, 0x62, 0xa6, 0x05, 0x0f, 0x61,
+	0x08, 0x09, 0x0f, 0xdf, 0x0d, 0x06, 0x03, 0x67, 0x09, 0x0f, 0x2a, 0x02,
+	0x00, 0x0e, 0x91, 0x0f, 0x0f, 0x02, 0x00, 0x0c, 0x2f, 0x68, 0x75, 0x7c,
+	0x14, 0x09, 0x0f, 0x15, 0x07, 0x05, 0x1f, 0x6b, 0xc7, 0x08, 0x04, 0x02,
+	0x9c, 0x01, 0x0f, 0xc1, 0x0f, 0x0a, 0x2b, 0x72, 0x62, 0x05, 0x00, 0x0d,
+	0x07, 0x00, 0x11, 0x66, 0x43, 0x00, 0x1f, 0x61, 0xd2, 0x09, 0x01, 0x2f,
+	0x62, 0x61, 0x04, 0x00, 0x1b, 0x0f, 0x03, 0x00, 0x07, 0x14, 0x71, 0x23,
+	0x0f, 0x2f, 0x64, 0x6c, 0x0b, 0x16, 0x08, 0x0e, 0x01, 0x00, 0x1f, 0x62,
+	0xb2, 0x04, 0x07, 0x10, 0x70, 0x02, 0x00, 0x1f, 0x61, 0x08, 0x00, 0x0a,
+	0x0f, 0xf1, 0x0e, 0x03, 0x0e, 0x7e, 0x0c, 0x33, 0x74, 0x74, 0x6c, 0x3b,
+	0x04, 0x2e, 0x6e, 0x6f, 0xbd, 0x0a, 0x01, 0x03, 0x00, 0x0f, 0x02, 0x00,
+	0x08, 0x1f, 0x75, 0x06, 0x00, 0x04, 0x0b, 0x08, 0x07, 0x11, 0x61, 0xcd,
+	0x0c, 0x2f, 0x77, 0x73, 0x07, 0x0d, 0x06, 0x0b, 0xbe, 0x04, 0x0f, 0x3b,
+	0x02, 0x03, 0x0c, 0x05, 0x00, 0x0f, 0xa9, 0x05, 0x02, 0x00, 0x10, 0x00,
+	0x0f, 0xfb, 0x17, 0x05, 0x3f, 0x73, 0x6d, 0x63, 0x05, 0x00, 0x07, 0x0f,
+	0x61, 0x0b, 0x06, 0x1b, 0x76, 0x2d, 0x07, 0x0f, 0x3d, 0x04, 0x01, 0x0f,
+	0xe6, 0x0f, 0x00, 0x0b, 0x50, 0x19, 0x1c, 0x62, 0x00, 0x0f, 0x0f, 0x02,
+	0x00, 0x0a, 0x0d, 0x9c, 0x01, 0x0f, 0xaf, 0x10, 0x08, 0x00, 0x08, 0x00,
+	0x0f, 0x57, 0x02, 0x00, 0x02, 0x03, 0x0a, 0x08, 0x71, 0x00, 0x00, 0x06,
+	0x00, 0x1f, 0x7a, 0xb9, 0x16, 0x10, 0x02, 0x12, 0x0f, 0x0f, 0x12, 0x1a,
+	0x0b, 0x2f, 0x73, 0x6f, 0xff, 0x0a, 0x03, 0x0f, 0x9e, 0x03, 0x04, 0x0f,
+	0xef, 0x14, 0x0b, 0x0f, 0xd0, 0x0d, 0x01, 0x1f, 0x6d, 0x05, 0x00, 0x09,
+	0x0c, 0xe6, 0x08, 0x04, 0x06, 0x00, 0x0c, 0x04, 0x00, 0x0f, 0x10, 0x14,
+	0x0a, 0x06, 0x05, 0x00, 0x0f, 0x04, 0x00, 0x03, 0x0d, 0x40, 0x10, 0x05,
+	0x64, 0x0c, 0x03, 0x33, 0x09, 0x1f, 0x79, 0x01, 0x00, 0x0a, 0x0b, 0x65,
+	0x14, 0x00, 0x03, 0x00, 0x07, 0x64, 0x0c, 0x01, 0x2e, 0x0f, 0x1f, 0x61,
+	0xe6, 0x19, 0x0c, 0x02, 0x22, 0x0f, 0x08, 0x35, 0x0f, 0x0f, 0x7d, 0x1b,
+	0x09, 0x0f, 0xf9, 0x05, 0x0a, 0x0d, 0x04, 0x00, 0x0c, 0x05, 0x00, 0x1e,
+	0x79, 0x03, 0x00, 0x0c, 0x4e, 0x07, 0x0f, 0x1a, 0x0c, 0x0c, 0x02, 0x04,
+	0x00, 0x0f, 0xe1, 0x05, 0x00, 0x0c, 0x77, 0x16, 0x1f, 0x73, 0x21, 0x15,
+	0x0d, 0x0f, 0x30, 0x06, 0x02, 0x1f, 0x69, 0xb0, 0x09, 0x0c, 0x1f, 0x6b,
+	0x94, 0x12, 0x05, 0x0f, 0x32, 0x0e, 0x0c, 0x0b, 0x01, 0x00, 0x12, 0x76,
+	0x2b, 0x0e, 0x07, 0x05, 0x00, 0x1f, 0x6a, 0x05, 0x00, 0x0c, 0x0c, 0x79,
+	0x16, 0x0f, 0x8c, 0x0f, 0x02, 0x1f, 0x70, 0x56, 0x08, 0x09, 0x0f, 0xb9,
+	0x03, 0x0b, 0x1f, 0x76, 0xdd, 0x18, 0x03, 0x0f, 0xac, 0x0e, 0x08, 0x06,
+	0x1f, 0x15, 0x0f, 0x03, 0x00, 0x04, 0x5a, 0x68, 0x76, 0x75, 0x61, 0x62,
+	0x85, 0x07, 0x0c, 0x56, 0x0a, 0x0f, 0x68, 0x17, 0x01, 0x0f, 0x06, 0x00,
+	0x08, 0x2f, 0x74, 0x66, 0x07, 0x00, 0x03, 0x1f, 0x72, 0x50, 0x0a, 0x0b,
+	0x00, 0x65, 0x05, 0x25, 0x74, 0x6c, 0x04, 0x00, 0x0e, 0x89, 0x16, 0x0f,
+	0x14, 0x14, 0x06, 0x26, 0x77, 0x74, 0x04, 0x03, 0x1f, 0x74, 0x06, 0x00,
+	0x08, 0x14, 0x70, 0xf7, 0x04, 0x0c, 0x07, 0x00, 0x0d, 0x05, 0x00, 0x1f,
+	0x65, 0x7e, 0x05, 0x05, 0x17, 0x76, 0x48, 0x17, 0x50, 0x74, 0x6e, 0x6c,
+	0x6b, 0x78,
+};
+
+static int __init test_lz4_check(const u8 *corpus, u8 *out)
+{
+	size_t len, n;
+	int ret;
+
+	len = CORPUS_SIZE;
+	ret = lz4_decompress_unknownoutputsize(test_lz4_block,
+			sizeof(test_lz4_block), out, &len);
+	if (ret || len != CORPUS_SIZE || memcmp(out, corpus, len)) {
+		printk(KERN_ERR "test_lz4: decompression failed\n");
+		return -EINVAL;
+	}
+
+	len = CORPUS_SIZE - 1;
+	if (!lz4_decompress_unknownoutputsize(test_lz4_block,
+			sizeof(test_lz4_block), out, &len)) {
+		printk(KERN_ERR "test_lz4: output overrun not detected\n");
+		return -EINVAL;
+	}
+
+	/* a truncated block may only decode to a prefix of the corpus */
+	for (n = 0; n < sizeof(test_lz4_block); n++) {
+		len = CORPUS_SIZE;
+		if (lz4_decompress_unknownoutputsize(test_lz4_block, n,
+						     out, &len))
+			continue;
+		if (len > CORPUS_SIZE || memcmp(out, corpus, len)) {
+			printk(KERN_ERR "test_lz4: bad output for input truncated to %zu bytes\n",
+			       n);
+			return -EINVAL;
+		}
+	}
+	return 0;
+}
+
+static int __init test_lz4_init(void)
+{
+	unsigned int n;
+	u8 *corpus, *out;
+	u64 bytes;
+	s64 ns;
+	ktime_t t0;
+	size_t len;
+	int ret = -ENOMEM;
+
+	corpus = kmalloc(CORPUS_SIZE, GFP_KERNEL);
+	out = kmalloc(CORPUS_SIZE, GFP_KERNEL);
+	if (!corpus || !out)
+		goto out;
+
+	test_corpus_fill(corpus, CORPUS_SIZE, 0x2545f491, 16, 4, 28);
+	ret = test_lz4_check(corpus, out);
+	if (ret)
+		goto out;
+
+	t0 = ktime_get();
+	for (n = 0; n < iterations; n++) {
+		len = CORPUS_SIZE;
+		lz4_decompress_unknownoutputsize(test_lz4_block,
+				sizeof(test_lz4_block), out, &len);
+	}
+	ns = ktime_to_ns(ktime_sub(ktime_get(), t0));
+
+	bytes = (u64)CORPUS_SIZE * iterations * 1000;
+	do_div(bytes, (u32)(ns / 1000 ? ns / 1000 : 1));
+	printk(KERN_INFO "test_lz4: all tests passed, %lu MB/s (%u -> %u bytes)\n",
+	       (unsigned long)(bytes >> 20), (unsigned int)sizeof(test_lz4_block),
+	       CORPUS_SIZE);
+out:
+	kfree(out);
+	kfree(corpus);
+	return ret;
+}
+
+static void __exit test_lz4_exit(void)
+{
+}
+
+module_init(test_lz4_init);
+module_exit(test_lz4_exit);
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("LZ4 decompressor self-test");
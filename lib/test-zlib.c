@@ -0,0 +1,205 @@
+/*
+ * Runtime benchmark for the in-kernel zlib inflate and Adler-32 code.
+ *
+ * A test corpus is generated, compressed with zlib_deflate and then
+ * decompressed repeatedly with both the optimized and the byte-at-a-time
+ * inflate_fast() loops; Adler-32 is timed with the portable C code and
+ * with whatever zlib_adler32() resolves to on this kernel.  All results are
+ * checked against the corpus and each other.  Load the module to run the
+ * benchmark, unload it to run it again.
+ */
+#include <linux/hrtimer.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/vmalloc.h>
+#include <linux/zutil.h>
+
+#include "test-corpus.h"
+
+#define CORPUS_SIZE	(1024 * 1024)
+
+/* Shortest length checked for agreement; straddles the NEON threshold */
+#define ADLER32_CHECK_MIN	200
+
+static unsigned int iterations = 8;
+module_param(iterations, uint, 0444);
+MODULE_PARM_DESC(iterations, "Number of passes per measurement");
+
+static u8 *corpus, *packed, *unpacked;
+static unsigned int packed_len;
+
+static int __init test_zlib_deflate(int level)
+{
+	z_stream s;
+	int ret;
+
+	memset(&s, 0, sizeof(s));
+	s.workspace = vmalloc(zlib_deflate_workspacesize(MAX_WBITS,
+							 MAX_MEM_LEVEL));
+	if (!s.workspace)
+		return -ENOMEM;
+
+	ret = zlib_deflateInit2(&s, level, Z_DEFLATED, MAX_WBITS,
+				DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK)
+		goto out;
+
+	s.next_in = corpus;
+	s.avail_in = CORPUS_SIZE;
+	s.next_out = packed;
+	s.avail_out = 2 * CORPUS_SIZE;
+	ret = zlib_deflate(&s, Z_FINISH);
+	packed_len = s.total_out;
+	zlib_deflateEnd(&s);
+	ret = ret == Z_STREAM_END ? 0 : -EINVAL;
+out:
+	vfree(s.workspace);
+	return ret;
+}
+
+/* Returns the time taken in ns, or a negative error code */
+static s64 __init test_zlib_inflate(void *workspace,
+				    int (*inflate)(z_streamp strm, int flush))
+{
+	unsigned int n;
+	ktime_t t0;
+	z_stream s;
+	int ret;
+
+	t0 = ktime_get();
+	for (n = 0; n < iterations; n++) {
+		memset(&s, 0, sizeof(s));
+		s.workspace = workspace;
+		if (zlib_inflateInit2(&s, MAX_WBITS) != Z_OK)
+			return -EINVAL;
+		s.next_in = packed;
+		s.avail_in = packed_len;
+		s.next_out = unpacked;
+		s.avail_out = CORPUS_SIZE;
+		ret = inflate(&s, Z_FINISH);
+		zlib_inflateEnd(&s);
+		if (ret != Z_STREAM_END || s.total_out != CORPUS_SIZE)
+			return -EINVAL;
+	}
+
+	if (memcmp(corpus, unpacked, CORPUS_SIZE))
+		return -EINVAL;
+	return ktime_to_ns(ktime_sub(ktime_get(), t0));
+}
+
+static unsigned long __init test_zlib_mbps(s64 ns)
+{
+	u64 bytes = (u64)CORPUS_SIZE * iterations * 1000;
+
+	if (ns <= 0)
+		return 0;
+	do_div(bytes, (u32)(ns / 1000 ? ns / 1000 : 1));
+	return (unsigned long)(bytes >> 20);
+}
+
+static int __init test_zlib_adler32(void)
+{
+	static const unsigned int sizes[] __initconst = { 64, 512, 4096, 65536 };
+	unsigned int i, n, off;
+	uLong ref, opt;
+	ktime_t t0;
+	s64 t_ref, t_opt;
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		unsigned int len = sizes[i];
+		unsigned int passes = iterations * (CORPUS_SIZE / len);
+
+		ref = opt = 1;
+		t0 = ktime_get();
+		for (n = 0, off = 0; n < passes; n++, off = (off + len) % CORPUS_SIZE)
+			ref = __zlib_adler32(ref, corpus + off, len);
+		t_ref = ktime_to_ns(ktime_sub(ktime_get(), t0));
+
+		t0 = ktime_get();
+		for (n = 0, off = 0; n < passes; n++, off = (off + len) % CORPUS_SIZE)
+			opt = zlib_adler32(opt, corpus + off, len);
+		t_opt = ktime_to_ns(ktime_sub(ktime_get(), t0));
+
+		if (ref != opt) {
+			printk(KERN_ERR "test_zlib: adler32 mismatch for %u byte buffers: %08lx != %08lx\n",
+			       len, opt, ref);
+			return -EINVAL;
+		}
+		printk(KERN_INFO "test_zlib: adler32 %5u bytes: c %lu MB/s, zlib_adler32 %lu MB/s\n",
+		       len, test_zlib_mbps(t_ref), test_zlib_mbps(t_opt));
+	}
+
+	/* Unaligned starts and odd lengths around the block size */
+	for (off = 0; off < 64; off++) {
+		for (n = ADLER32_CHECK_MIN; n < ADLER32_CHECK_MIN + 64; n++) {
+			ref = __zlib_adler32(1, corpus + off, n);
+			opt = zlib_adler32(1, corpus + off, n);
+			if (ref != opt) {
+				printk(KERN_ERR "test_zlib: adler32 mismatch at offset %u length %u\n",
+				       off, n);
+				return -EINVAL;
+			}
+		}
+	}
+	return 0;
+}
+
+static int __init test_zlib_init(void)
+{
+	static const int levels[] __initconst = { 1, 6, 9 };
+	void *workspace;
+	unsigned int i;
+	int ret = -ENOMEM;
+
+	corpus = vmalloc(CORPUS_SIZE);
+	packed = vmalloc(2 * CORPUS_SIZE);
+	unpacked = vmalloc(CORPUS_SIZE);
+	workspace = vmalloc(zlib_inflate_workspacesize());
+	if (!corpus || !packed || !unpacked || !workspace)
+		goto out;
+
+	test_corpus_fill(corpus, CORPUS_SIZE, 0x12345678, 64, 3, 60);
+
+	for (i = 0; i < ARRAY_SIZE(levels); i++) {
+		s64 t_ref, t_opt;
+
+		ret = test_zlib_deflate(levels[i]);
+		if (ret) {
+			printk(KERN_ERR "test_zlib: deflate level %d failed\n",
+			       levels[i]);
+			goto out;
+		}
+
+		t_ref = test_zlib_inflate(workspace, zlib_inflate_ref);
+		t_opt = test_zlib_inflate(workspace, zlib_inflate);
+		if (t_ref < 0 || t_opt < 0) {
+			printk(KERN_ERR "test_zlib: inflate of level %d data failed\n",
+			       levels[i]);
+			ret = -EINVAL;
+			goto out;
+		}
+		printk(KERN_INFO "test_zlib: level %d (%u -> %u bytes): inflate ref %lu MB/s, fast %lu MB/s\n",
+		       levels[i], CORPUS_SIZE, packed_len,
+		       test_zlib_mbps(t_ref), test_zlib_mbps(t_opt));
+	}
+
+	ret = test_zlib_adler32();
+	if (!ret)
+		printk(KERN_INFO "test_zlib: all tests passed\n");
+out:
+	vfree(workspace);
+	vfree(unpacked);
+	vfree(packed);
+	vfree(corpus);
+	return ret;
+}
+
+static void __exit test_zlib_exit(void)
+{
+}
+
+module_init(test_zlib_init);
+module_exit(test_zlib_exit);
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("zlib inflate and Adler-32 benchmark");
@@ -89,8 +89,19 @@ struct dictionary {
 
 	/* Operation mode */
 	enum xz_mode mode;
+
+#ifdef XZ_DEC_BENCH
+	/* Use the plain literal decoder and match copy, see xz_dec_set_ref() */
+	bool ref;
+#endif
 };
 
+#ifdef XZ_DEC_BENCH
+#	define dict_ref(dict) ((dict)->ref)
+#else
+#	define dict_ref(dict) false
+#endif
+
 /* Range decoder */
 struct rc_dec {
 	uint32_t range;
@@ -358,6 +369,34 @@ static bool dict_repeat(struct dictionary *dict, uint32_t *len, uint32_t dist)
 	if (dist >= dict->pos)
 		back += dict->end;
 
+#ifdef XZ_DEC_FAST
+	/*
+	 * If the source doesn't wrap around the end of the circular buffer,
+	 * copy without checking for the wrap on every byte. Non-overlapping
+	 * copies can use memcpy(); overlapping ones must go byte by byte
+	 * to replicate the pattern.
+	 */
+	if (back < dict->pos && !dict_ref(dict)) {
+		uint8_t *dst = dict->buf + dict->pos;
+		const uint8_t *src = dict->buf + back;
+
+		dict->pos += left;
+
+		if (left <= dist + 1) {
+			memcpy(dst, src, left);
+		} else {
+			do {
+				*dst++ = *src++;
+			} while (--left > 0);
+		}
+
+		if (dict->full < dict->pos)
+			dict->full = dict->pos;
+
+		return true;
+	}
+#endif
+
 	do {
 		dict->buf[dict->pos++] = dict->buf[back++];
 		if (back == dict->end)
@@ -577,8 +616,91 @@ static uint16_t *lzma_literal_probs(struct xz_dec_lzma2 *s)
 	return s->lzma.literal[low + high];
 }
 
+#ifdef XZ_DEC_BENCH
+static void lzma_literal_ref(struct xz_dec_lzma2 *s);
+#endif
+
+#ifdef XZ_DEC_FAST
+/*
+ * Speed-optimized literal decoder. Literals are the most common symbols,
+ * so:
+ *
+ *  - The range decoder state is copied to a local variable for the
+ *    duration of the literal. The kernel is built with
+ *    -fno-strict-aliasing, so going through s->rc would make the compiler
+ *    reload range and code after every probability update.
+ *
+ *  - The eight bits of a plain literal are decoded without a loop.
+ *
+ *  - The probabilities of the next literal are prefetched as soon as the
+ *    byte that selects them is known, which hides most of the cache miss
+ *    on the 24 KiB (lc=3) literal probability table.
+ */
+static void lzma_literal(struct xz_dec_lzma2 *s)
+{
+	struct rc_dec rc = s->rc;
+	uint16_t *probs;
+	uint32_t symbol;
+	uint32_t match_byte;
+	uint32_t match_bit;
+	uint32_t offset;
+	uint32_t i;
+
+	if (dict_ref(&s->dict)) {
+		lzma_literal_ref(s);
+		return;
+	}
+
+	probs = lzma_literal_probs(s);
+
+	if (lzma_state_is_literal(s->lzma.state)) {
+		symbol = 1;
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+		symbol = (symbol << 1) + rc_bit(&rc, &probs[symbol]);
+	} else {
+		symbol = 1;
+		match_byte = dict_get(&s->dict, s->lzma.rep0) << 1;
+		offset = 0x100;
+
+		do {
+			match_bit = match_byte & offset;
+			match_byte <<= 1;
+			i = offset + match_bit + symbol;
+
+			if (rc_bit(&rc, &probs[i])) {
+				symbol = (symbol << 1) + 1;
+				offset &= match_bit;
+			} else {
+				symbol <<= 1;
+				offset &= ~match_bit;
+			}
+		} while (symbol < 0x100);
+	}
+
+	s->rc.range = rc.range;
+	s->rc.code = rc.code;
+	s->rc.in_pos = rc.in_pos;
+
+	dict_put(&s->dict, (uint8_t)symbol);
+	lzma_state_literal(&s->lzma.state);
+
+	__builtin_prefetch(lzma_literal_probs(s));
+}
+#endif
+
+#if !defined(XZ_DEC_FAST) || defined(XZ_DEC_BENCH)
 /* Decode a literal (one 8-bit byte) */
+#ifdef XZ_DEC_BENCH
+static void lzma_literal_ref(struct xz_dec_lzma2 *s)
+#else
 static void lzma_literal(struct xz_dec_lzma2 *s)
+#endif
 {
 	uint16_t *probs;
 	uint32_t symbol;
@@ -614,6 +736,7 @@ static void lzma_literal(struct xz_dec_lzma2 *s)
 	dict_put(&s->dict, (uint8_t)symbol);
 	lzma_state_literal(&s->lzma.state);
 }
+#endif
 
 /* Decode the length of the match into s->lzma.len. */
 static void lzma_len(struct xz_dec_lzma2 *s, struct lzma_len_dec *l,
@@ -1110,6 +1233,9 @@ XZ_EXTERN struct xz_dec_lzma2 *xz_dec_lzma2_create(enum xz_mode mode,
 
 	s->dict.mode = mode;
 	s->dict.size_max = dict_max;
+#ifdef XZ_DEC_BENCH
+	s->dict.ref = false;
+#endif
 
 	if (DEC_IS_PREALLOC(mode)) {
 		s->dict.buf = vmalloc(dict_max);
@@ -1125,6 +1251,13 @@ XZ_EXTERN struct xz_dec_lzma2 *xz_dec_lzma2_create(enum xz_mode mode,
 	return s;
 }
 
+#ifdef XZ_DEC_BENCH
+XZ_EXTERN void xz_dec_lzma2_set_ref(struct xz_dec_lzma2 *s, bool ref)
+{
+	s->dict.ref = ref;
+}
+#endif
+
 XZ_EXTERN enum xz_ret xz_dec_lzma2_reset(struct xz_dec_lzma2 *s, uint8_t props)
 {
 	/* This limits dictionary size to 3 GiB to keep parsing simpler. */
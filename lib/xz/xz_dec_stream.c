@@ -809,6 +809,13 @@ XZ_EXTERN void xz_dec_reset(struct xz_dec *s)
 	s->temp.size = STREAM_HEADER_SIZE;
 }
 
+#ifdef XZ_DEC_BENCH
+XZ_EXTERN void xz_dec_set_ref(struct xz_dec *s, bool ref)
+{
+	xz_dec_lzma2_set_ref(s->lzma2, ref);
+}
+#endif
+
 XZ_EXTERN void xz_dec_end(struct xz_dec *s)
 {
 	if (s != NULL) {
@@ -12,6 +12,7 @@
 #include <linux/fs.h>
 #include <linux/uaccess.h>
 #include <linux/crc32.h>
+#include <linux/hrtimer.h>
 #include <linux/xz.h>
 
 /* Maximum supported dictionary size */
@@ -61,6 +62,32 @@ static struct xz_buf buffers = {
  */
 static uint32_t crc;
 
+/*
+ * Amount of uncompressed data and the time spent in xz_dec_run() producing
+ * it. Copying from the userspace and calculating the CRC32 aren't counted,
+ * so the reported throughput is that of the decoder alone.
+ */
+static uint64_t total_out;
+static s64 decode_ns;
+
+#ifdef CONFIG_XZ_DEC_BENCH
+/*
+ * A second decoder state using the plain decoding loops. It decodes the
+ * same input as the main one, so that the speed of the two can be compared
+ * in a single run.
+ */
+static struct xz_dec *state_ref;
+static enum xz_ret ret_ref;
+static uint32_t crc_ref;
+static s64 decode_ref_ns;
+
+static struct xz_buf buffers_ref = {
+	.in = buffer_in,
+	.out = buffer_out,
+	.out_size = sizeof(buffer_out)
+};
+#endif
+
 static int xz_dec_test_open(struct inode *i, struct file *f)
 {
 	if (device_is_open)
@@ -71,11 +98,20 @@ static int xz_dec_test_open(struct inode *i, struct file *f)
 	xz_dec_reset(state);
 	ret = XZ_OK;
 	crc = 0xFFFFFFFF;
+	total_out = 0;
+	decode_ns = 0;
 
 	buffers.in_pos = 0;
 	buffers.in_size = 0;
 	buffers.out_pos = 0;
 
+#ifdef CONFIG_XZ_DEC_BENCH
+	xz_dec_reset(state_ref);
+	ret_ref = XZ_OK;
+	crc_ref = 0xFFFFFFFF;
+	decode_ref_ns = 0;
+#endif
+
 	printk(KERN_INFO DEVICE_NAME ": opened\n");
 	return 0;
 }
@@ -91,6 +127,45 @@ static int xz_dec_test_release(struct inode *i, struct file *f)
 	return 0;
 }
 
+/* Print the decoder throughput of the Stream that was just decoded. */
+static void xz_dec_test_report(const char *loops, s64 ns)
+{
+	uint64_t us = div_u64(ns, 1000);
+	uint64_t kib_per_s = 0;
+
+	if (us > 0)
+		kib_per_s = div64_u64(total_out * 1000000, us) >> 10;
+
+	printk(KERN_INFO DEVICE_NAME ": %s: %llu bytes decoded in %llu us, "
+			"%llu KiB/s\n", loops, (unsigned long long)total_out,
+			(unsigned long long)us,
+			(unsigned long long)kib_per_s);
+}
+
+#ifdef CONFIG_XZ_DEC_BENCH
+/*
+ * Decode the input that was just copied to buffer_in with the reference
+ * decoder. Its output is only used for the CRC32, so buffer_out is shared.
+ */
+static void xz_dec_test_run_ref(void)
+{
+	ktime_t start;
+
+	buffers_ref.in_pos = 0;
+	buffers_ref.in_size = buffers.in_size;
+
+	while ((buffers_ref.in_pos < buffers_ref.in_size
+			|| buffers_ref.out_pos == buffers_ref.out_size)
+			&& ret_ref == XZ_OK) {
+		buffers_ref.out_pos = 0;
+		start = ktime_get();
+		ret_ref = xz_dec_run(state_ref, &buffers_ref);
+		decode_ref_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+		crc_ref = crc32(crc_ref, buffer_out, buffers_ref.out_pos);
+	}
+}
+#endif
+
 /*
  * Decode the data given to us from the userspace. CRC32 of the uncompressed
  * data is calculated and is printed at the end of successful decoding. The
@@ -103,6 +178,7 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 				 size_t size, loff_t *pos)
 {
 	size_t remaining;
+	ktime_t start;
 
 	if (ret != XZ_OK) {
 		if (size > 0)
@@ -127,10 +203,17 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 
 			buf += buffers.in_size;
 			remaining -= buffers.in_size;
+
+#ifdef CONFIG_XZ_DEC_BENCH
+			xz_dec_test_run_ref();
+#endif
 		}
 
 		buffers.out_pos = 0;
+		start = ktime_get();
 		ret = xz_dec_run(state, &buffers);
+		decode_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+		total_out += buffers.out_pos;
 		crc = crc32(crc, buffer_out, buffers.out_pos);
 	}
 
@@ -142,6 +225,16 @@ static ssize_t xz_dec_test_write(struct file *file, const char __user *buf,
 	case XZ_STREAM_END:
 		printk(KERN_INFO DEVICE_NAME ": XZ_STREAM_END, "
 				"CRC32 = 0x%08X\n", ~crc);
+#ifdef CONFIG_XZ_DEC_BENCH
+		xz_dec_test_report("fast loops", decode_ns);
+		xz_dec_test_report("reference loops", decode_ref_ns);
+		if (ret_ref != XZ_STREAM_END || crc_ref != crc)
+			printk(KERN_INFO DEVICE_NAME ": reference decoder "
+					"disagrees (%d, CRC32 = 0x%08X)\n",
+					ret_ref, ~crc_ref);
+#else
+		xz_dec_test_report("decoder", decode_ns);
+#endif
 		return size - remaining - (buffers.in_size - buffers.in_pos);
 
 	case XZ_MEMLIMIT_ERROR:
@@ -186,8 +279,20 @@ static int __init xz_dec_test_init(void)
 	if (state == NULL)
 		return -ENOMEM;
 
+#ifdef CONFIG_XZ_DEC_BENCH
+	state_ref = xz_dec_init(XZ_PREALLOC, DICT_MAX);
+	if (state_ref == NULL) {
+		xz_dec_end(state);
+		return -ENOMEM;
+	}
+	xz_dec_set_ref(state_ref, true);
+#endif
+
 	device_major = register_chrdev(0, DEVICE_NAME, &fileops);
 	if (device_major < 0) {
+#ifdef CONFIG_XZ_DEC_BENCH
+		xz_dec_end(state_ref);
+#endif
 		xz_dec_end(state);
 		return device_major;
 	}
@@ -202,6 +307,9 @@ static int __init xz_dec_test_init(void)
 static void __exit xz_dec_test_exit(void)
 {
 	unregister_chrdev(device_major, DEVICE_NAME);
+#ifdef CONFIG_XZ_DEC_BENCH
+	xz_dec_end(state_ref);
+#endif
 	xz_dec_end(state);
 	printk(KERN_INFO DEVICE_NAME ": module unloaded\n");
 }
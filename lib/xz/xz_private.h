@@ -41,6 +41,12 @@
 #		define memzero(buf, size) memset(buf, 0, size)
 #	endif
 #	define get_le32(p) le32_to_cpup((const uint32_t *)(p))
+#	ifdef CONFIG_XZ_DEC_FAST
+#		define XZ_DEC_FAST
+#		if defined(CONFIG_XZ_DEC_BENCH) && !defined(XZ_PREBOOT)
+#			define XZ_DEC_BENCH
+#		endif
+#	endif
 #else
 	/*
 	 * For userspace builds, use a separate header to define the required
@@ -125,6 +131,11 @@ XZ_EXTERN enum xz_ret xz_dec_lzma2_run(struct xz_dec_lzma2 *s,
 /* Free the memory allocated for the LZMA2 decoder. */
 XZ_EXTERN void xz_dec_lzma2_end(struct xz_dec_lzma2 *s);
 
+#ifdef XZ_DEC_BENCH
+/* Select the plain literal decoder and match copy, for benchmarking. */
+XZ_EXTERN void xz_dec_lzma2_set_ref(struct xz_dec_lzma2 *s, bool ref);
+#endif
+
 #ifdef XZ_DEC_BCJ
 /*
  * Allocate memory for BCJ decoders. xz_dec_bcj_reset() must be used before
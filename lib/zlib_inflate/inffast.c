@@ -48,6 +48,73 @@ get_unaligned16(const unsigned short *p)
 #  define UP_UNALIGNED(a) get_unaligned16(++(a))
 #endif
 
+/*
+   With CONFIG_ZLIB_INFLATE_FAST the bit buffer is refilled 32 bits at a
+   time instead of one byte per check, and matches with a distance of at
+   least four bytes are copied a word at a time.  Word copies rely on cheap
+   unaligned loads and stores, which the pre-boot decompressor cannot
+   assume (the alignment trap may still be enabled there), so it only gets
+   the wider refill, with the input word assembled from bytes.
+ */
+#ifdef CONFIG_ZLIB_INFLATE_FAST
+#  define INFLATE_WIDE_HOLD 1
+#  if !defined(STATIC) && defined(__LITTLE_ENDIAN) && \
+      (defined(CONFIG_HAVE_EFFICIENT_UNALIGNED_ACCESS) || \
+       (defined(CONFIG_ARM) && __LINUX_ARM_ARCH__ >= 6))
+#    define INFLATE_WORD_COPY 1
+#  else
+#    define INFLATE_WORD_COPY 0
+#  endif
+#else
+#  define INFLATE_WIDE_HOLD 0
+#  define INFLATE_WORD_COPY 0
+#endif
+
+#if INFLATE_WORD_COPY
+struct inflate_una32 {
+	u32 x;
+} __attribute__((packed));
+
+static inline u32 inflate_load32(const unsigned char *p)
+{
+	return ((const struct inflate_una32 *)p)->x;
+}
+
+static inline void inflate_store32(unsigned char *p, u32 v)
+{
+	((struct inflate_una32 *)p)->x = v;
+}
+#else
+static inline u32 inflate_load32(const unsigned char *p)
+{
+	return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) |
+	       ((u32)p[3] << 24);
+}
+#endif
+
+/*
+   Make sure at least 15 bits are available in hold.  The wide refill loads
+   four input bytes at once but only accounts for the whole bytes that fit,
+   so the bits of hold above 'bits' may already hold the next input bytes.
+   Every refill therefore ORs new bytes in rather than adding them.
+ */
+#define PULL15(wide) \
+    do { \
+        if (bits < 15) { \
+            if ((wide) && in < lastw) { \
+                hold |= (unsigned long)inflate_load32(in + OFF) << bits; \
+                in += (31 - bits) >> 3; \
+                bits |= 24; \
+            } \
+            else { \
+                hold |= (unsigned long)(PUP(in)) << bits; \
+                bits += 8; \
+                hold |= (unsigned long)(PUP(in)) << bits; \
+                bits += 8; \
+            } \
+        } \
+    } while (0)
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -84,12 +151,17 @@ get_unaligned16(const unsigned short *p)
       output space.
 
     - @start:	inflate()'s starting value for strm->avail_out
+
+    - @wide:	use the 32-bit refill and word copies; constant at each call
+		site so the unused paths are compiled out
  */
-void inflate_fast(z_streamp strm, unsigned start)
+static __always_inline void inflate_fast_common(z_streamp strm,
+                                                unsigned start, const int wide)
 {
     struct inflate_state *state;
     const unsigned char *in;    /* local strm->next_in */
     const unsigned char *last;  /* while in < last, enough input available */
+    const unsigned char *lastw; /* while in < lastw, 32-bit refill allowed */
     unsigned char *out;         /* local strm->next_out */
     unsigned char *beg;         /* inflate()'s initial strm->next_out */
     unsigned char *end;         /* while out < end, enough space available */
@@ -117,6 +189,7 @@ void inflate_fast(z_streamp strm, unsigned start)
     state = (struct inflate_state *)strm->state;
     in = strm->next_in - OFF;
     last = in + (strm->avail_in - 5);
+    lastw = in + (strm->avail_in - 3);
     out = strm->next_out - OFF;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
@@ -137,12 +210,7 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
-        if (bits < 15) {
-            hold += (unsigned long)(PUP(in)) << bits;
-            bits += 8;
-            hold += (unsigned long)(PUP(in)) << bits;
-            bits += 8;
-        }
+        PULL15(wide);
         this = lcode[hold & lmask];
       dolen:
         op = (unsigned)(this.bits);
@@ -157,19 +225,14 @@ void inflate_fast(z_streamp strm, unsigned start)
             op &= 15;                           /* number of extra bits */
             if (op) {
                 if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
+                    hold |= (unsigned long)(PUP(in)) << bits;
                     bits += 8;
                 }
                 len += (unsigned)hold & ((1U << op) - 1);
                 hold >>= op;
                 bits -= op;
             }
-            if (bits < 15) {
-                hold += (unsigned long)(PUP(in)) << bits;
-                bits += 8;
-                hold += (unsigned long)(PUP(in)) << bits;
-                bits += 8;
-            }
+            PULL15(wide);
             this = dcode[hold & dmask];
           dodist:
             op = (unsigned)(this.bits);
@@ -180,10 +243,10 @@ void inflate_fast(z_streamp strm, unsigned start)
                 dist = (unsigned)(this.val);
                 op &= 15;                       /* number of extra bits */
                 if (bits < op) {
-                    hold += (unsigned long)(PUP(in)) << bits;
+                    hold |= (unsigned long)(PUP(in)) << bits;
                     bits += 8;
                     if (bits < op) {
-                        hold += (unsigned long)(PUP(in)) << bits;
+                        hold |= (unsigned long)(PUP(in)) << bits;
                         bits += 8;
                     }
                 }
@@ -257,6 +320,22 @@ void inflate_fast(z_streamp strm, unsigned start)
                             PUP(out) = PUP(from);
                     }
                 }
+#if INFLATE_WORD_COPY
+                else if (wide && dist > 3) {
+                    /* a word never overlaps the bytes it is copied to */
+                    from = out - dist;          /* copy direct from output */
+                    while (len > 3) {
+                        inflate_store32(out + OFF, inflate_load32(from + OFF));
+                        out += 4;
+                        from += 4;
+                        len -= 4;
+                    }
+                    while (len) {
+                        PUP(out) = PUP(from);
+                        len--;
+                    }
+                }
+#endif
                 else {
 		    unsigned short *sout;
 		    unsigned long loops;
@@ -329,7 +408,10 @@ void inflate_fast(z_streamp strm, unsigned start)
         }
     } while (in < last && out < end);
 
-    /* return unused bytes (on entry, bits < 8, so in won't go too far back) */
+    /* return unused bytes: bits counts only bytes that in has been advanced
+       past (the wide refill leaves the rest of its load uncounted above
+       bits), and there were fewer than 8 on entry, so in stays within this
+       call's input; the mask below drops the uncounted bits */
     len = bits >> 3;
     in -= len;
     bits -= len << 3;
@@ -346,6 +428,19 @@ void inflate_fast(z_streamp strm, unsigned start)
     return;
 }
 
+void inflate_fast(z_streamp strm, unsigned start)
+{
+    inflate_fast_common(strm, start, INFLATE_WIDE_HOLD);
+}
+
+#if defined(CONFIG_ZLIB_INFLATE_BENCH) && !defined(STATIC)
+/* Byte-at-a-time variant, only kept so the benchmark can compare against it */
+void inflate_fast_ref(z_streamp strm, unsigned start)
+{
+    inflate_fast_common(strm, start, 0);
+}
+#endif
+
 /*
    inflate_fast() speedups that turned out slower (on a PowerPC G3 750CXe):
    - Using bit fields for code structure
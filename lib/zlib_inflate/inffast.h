@@ -9,3 +9,7 @@
  */
 
 void inflate_fast (z_streamp strm, unsigned start);
+
+#if defined(CONFIG_ZLIB_INFLATE_BENCH) && !defined(STATIC)
+void inflate_fast_ref (z_streamp strm, unsigned start);
+#endif
@@ -329,7 +329,26 @@ static int zlib_inflateSyncPacket(z_streamp strm)
    will return Z_BUF_ERROR if it has not reached the end of the stream.
  */
 
+#if defined(CONFIG_ZLIB_INFLATE_BENCH) && !defined(STATIC)
+static int inflate_common(z_streamp strm, int flush,
+                          void (*fast)(z_streamp strm, unsigned start));
+
+int zlib_inflate(z_streamp strm, int flush)
+{
+    return inflate_common(strm, flush, inflate_fast);
+}
+
+/* zlib_inflate() with the byte-at-a-time fast loop, for the benchmark */
+int zlib_inflate_ref(z_streamp strm, int flush)
+{
+    return inflate_common(strm, flush, inflate_fast_ref);
+}
+
+static int inflate_common(z_streamp strm, int flush,
+                          void (*fast)(z_streamp strm, unsigned start))
+#else
 int zlib_inflate(z_streamp strm, int flush)
+#endif
 {
     struct inflate_state *state;
     const unsigned char *next;  /* next input */
@@ -572,7 +591,11 @@ int zlib_inflate(z_streamp strm, int flush)
         case LEN:
             if (have >= 6 && left >= 258) {
                 RESTORE();
+#if defined(CONFIG_ZLIB_INFLATE_BENCH) && !defined(STATIC)
+                fast(strm, out);
+#else
                 inflate_fast(strm, out);
+#endif
                 LOAD();
                 break;
             }
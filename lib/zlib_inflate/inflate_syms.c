@@ -17,4 +17,7 @@ EXPORT_SYMBOL(zlib_inflateEnd);
 EXPORT_SYMBOL(zlib_inflateReset);
 EXPORT_SYMBOL(zlib_inflateIncomp); 
 EXPORT_SYMBOL(zlib_inflate_blob);
+#ifdef CONFIG_ZLIB_INFLATE_BENCH
+EXPORT_SYMBOL(zlib_inflate_ref);
+#endif
 MODULE_LICENSE("GPL");
@@ -1077,6 +1077,7 @@ static void do_generic_file_read(struct file *filp, loff_t *ppos,
 	pgoff_t prev_index;
 	unsigned long offset;      /* offset into pagecache page */
 	unsigned int prev_offset;
+	bool missed = false;
 	int error;
 
 	index = *ppos >> PAGE_CACHE_SHIFT;
@@ -1095,12 +1096,19 @@ static void do_generic_file_read(struct file *filp, loff_t *ppos,
 find_page:
 		page = find_get_page(mapping, index);
 		if (!page) {
+			ra->misses++;
+			missed = true;
 			page_cache_sync_readahead(mapping,
 					ra, filp,
 					index, last_index - index);
 			page = find_get_page(mapping, index);
 			if (unlikely(page == NULL))
 				goto no_cached_page;
+		} else if (PageUptodate(page)) {
+			ra->hits++;
+		} else if (!missed) {
+			/* not part of the sync readahead just submitted */
+			page_cache_readahead_wait(ra);
 		}
 		if (PageReadahead(page)) {
 			page_cache_async_readahead(mapping,
@@ -56,6 +56,25 @@ static inline long sync_writeback_pages(unsigned long dirtied)
 	return dirtied + dirtied / 2;
 }
 
+/*
+ * Estimate write bandwidth at 200ms intervals.
+ */
+#define BANDWIDTH_INTERVAL	max(HZ/5, 1)
+
+/*
+ * Longest nap in balance_dirty_pages().
+ */
+#define MAX_PAUSE		max(HZ/5, 1)
+
+/*
+ * A bdi is not allowed more dirty pages than it can write back in this
+ * many seconds at its estimated bandwidth, but always gets BDI_MIN_DIRTY.
+ * This keeps a slow SD card or USB stick from eating the global dirty
+ * limit and throttling the writers of the other devices.
+ */
+#define BDI_DIRTY_TIME		2
+#define BDI_MIN_DIRTY		(4 << (20 - PAGE_SHIFT))
+
 /* The following parameters are exported via /proc/sys/vm */
 
 /*
@@ -219,6 +238,7 @@ int dirty_bytes_handler(struct ctl_table *table, int write,
  */
 static inline void __bdi_writeout_inc(struct backing_dev_info *bdi)
 {
+	__inc_bdi_stat(bdi, BDI_WRITTEN);
 	__prop_inc_percpu_max(&vm_completions, &bdi->completions,
 			      bdi->max_prop_frac);
 }
@@ -465,9 +485,127 @@ unsigned long bdi_dirty_limit(struct backing_dev_info *bdi, unsigned long dirty)
 	if (bdi_dirty > (dirty * bdi->max_ratio) / 100)
 		bdi_dirty = dirty * bdi->max_ratio / 100;
 
+	/*
+	 * The writeout fraction follows the device speed only while all the
+	 * devices are busy; also cap the share by what the device is
+	 * measured to write in BDI_DIRTY_TIME.
+	 */
+	if (bdi_cap_writeback_dirty(bdi)) {
+		unsigned long bw_dirty;
+
+		bw_dirty = max_t(unsigned long,
+				 bdi->avg_write_bandwidth * BDI_DIRTY_TIME,
+				 BDI_MIN_DIRTY);
+		bw_dirty = max(bw_dirty, (dirty * bdi->min_ratio) / 100);
+		if (bdi_dirty > bw_dirty)
+			bdi_dirty = bw_dirty;
+	}
+
 	return bdi_dirty;
 }
 
+static void bdi_update_write_bandwidth(struct backing_dev_info *bdi,
+				       unsigned long elapsed,
+				       unsigned long written)
+{
+	const unsigned long period = roundup_pow_of_two(3 * HZ);
+	unsigned long avg = bdi->avg_write_bandwidth;
+	unsigned long old = bdi->write_bandwidth;
+	u64 bw;
+
+	/*
+	 * bw = written * HZ / elapsed
+	 *
+	 *                   bw * elapsed + write_bandwidth * (period - elapsed)
+	 * write_bandwidth = ---------------------------------------------------
+	 *                                          period
+	 */
+	bw = written - bdi->written_stamp;
+	bw *= HZ;
+	if (unlikely(elapsed > period)) {
+		do_div(bw, elapsed);
+		avg = bw;
+		goto out;
+	}
+	bw += (u64)bdi->write_bandwidth * (period - elapsed);
+	bw >>= ilog2(period);
+
+	/*
+	 * one more level of smoothing, for filtering out sudden spikes
+	 */
+	if (avg > old && old >= (unsigned long)bw)
+		avg -= (avg - old) >> 3;
+
+	if (avg < old && old <= (unsigned long)bw)
+		avg += (old - avg) >> 3;
+
+out:
+	bdi->write_bandwidth = bw;
+	bdi->avg_write_bandwidth = avg;
+}
+
+/**
+ * bdi_update_bandwidth - update the write bandwidth estimation of a bdi
+ * @bdi: the backing device
+ * @start_time: when the caller started writing back or throttling
+ *
+ * Called from the flusher and from throttled dirtiers while @bdi is busy.
+ * Periods in which nobody has been writing back for a second are skipped,
+ * they would just measure the idle time.
+ */
+void bdi_update_bandwidth(struct backing_dev_info *bdi,
+			  unsigned long start_time)
+{
+	unsigned long now = jiffies;
+	unsigned long elapsed;
+	unsigned long written;
+
+	if (time_is_after_eq_jiffies(bdi->bw_time_stamp + BANDWIDTH_INTERVAL))
+		return;
+
+	spin_lock(&bdi->bw_lock);
+	elapsed = now - bdi->bw_time_stamp;
+	if (elapsed < BANDWIDTH_INTERVAL)
+		goto unlock;
+
+	written = percpu_counter_read(&bdi->bdi_stat[BDI_WRITTEN]);
+
+	if (elapsed <= HZ || !time_before(bdi->bw_time_stamp, start_time))
+		bdi_update_write_bandwidth(bdi, elapsed, written);
+
+	bdi->written_stamp = written;
+	bdi->bw_time_stamp = now;
+unlock:
+	spin_unlock(&bdi->bw_lock);
+}
+
+/*
+ * How long a dirtier over its limit sleeps: the time @bdi takes to write
+ * back the @pages it has dirtied, stretched by how far the bdi is over
+ * its threshold.  Writers to a slow device are so paced at the device
+ * speed instead of being put to sleep in growing, fixed steps.
+ */
+static unsigned long dirty_pause(struct backing_dev_info *bdi,
+				 unsigned long pages,
+				 unsigned long bdi_dirty,
+				 unsigned long bdi_thresh)
+{
+	unsigned long bw = bdi->avg_write_bandwidth;
+	u64 pause;
+
+	if (!bw)
+		return MAX_PAUSE;
+
+	pause = (u64)pages * HZ;
+	if (bdi_thresh && bdi_dirty > bdi_thresh) {
+		pause *= bdi_dirty;
+		do_div(pause, bdi_thresh);
+	}
+	pause = div_u64(pause + bw - 1, bw);
+
+	return clamp_t(unsigned long, pause, 1, MAX_PAUSE);
+}
+
 /*
  * balance_dirty_pages() must be called by processes which are generating dirty
  * data.  It looks at the number of dirty pages in the machine and will force
@@ -484,7 +622,8 @@ static void balance_dirty_pages(struct address_space *mapping,
 	unsigned long dirty_thresh;
 	unsigned long bdi_thresh;
 	unsigned long pages_written = 0;
-	unsigned long pause = 1;
+	unsigned long pause;
+	unsigned long start_time = jiffies;
 	bool dirty_exceeded = false;
 	struct backing_dev_info *bdi = mapping->backing_dev_info;
 
@@ -548,6 +687,8 @@ static void balance_dirty_pages(struct address_space *mapping,
 		if (!bdi->dirty_exceeded)
 			bdi->dirty_exceeded = 1;
 
+		bdi_update_bandwidth(bdi, start_time);
+
 		/* Note: nr_reclaimable denotes nr_dirty + nr_unstable.
 		 * Unstable writes are a feature of certain networked
 		 * filesystems (i.e. NFS) in which data may have been
@@ -565,17 +706,17 @@ static void balance_dirty_pages(struct address_space *mapping,
 			if (pages_written >= write_chunk)
 				break;		/* We've done our duty */
 		}
+		pause = dirty_pause(bdi, write_chunk - pages_written,
+				    bdi_nr_reclaimable + bdi_nr_writeback,
+				    bdi_thresh);
+		bdi->dirty_pauses++;
+		bdi->dirty_pause_time += pause;
+		if (pause > bdi->dirty_pause_max)
+			bdi->dirty_pause_max = pause;
+
 		trace_wbc_balance_dirty_wait(&wbc, bdi);
 		__set_current_state(TASK_UNINTERRUPTIBLE);
 		io_schedule_timeout(pause);
-
-		/*
-		 * Increase the delay for each loop, up to our previous
-		 * default of taking a 100ms nap.
-		 */
-		pause <<= 1;
-		if (pause > HZ / 10)
-			pause = HZ / 10;
 	}
 
 	if (!dirty_exceeded && bdi->dirty_exceeded)
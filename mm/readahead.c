@@ -20,13 +20,21 @@
 
 /*
  * Initialise a struct file's readahead state.  Assumes that the caller has
- * memset *ra to zero.
+ * memset *ra to zero, except for the adaptive window and statistics fields,
+ * which are cleared here because some callers keep *ra on the stack.
  */
 void
 file_ra_state_init(struct file_ra_state *ra, struct address_space *mapping)
 {
 	ra->ra_pages = mapping->backing_dev_info->ra_pages;
 	ra->prev_pos = -1;
+	ra->stamp = 0;
+	ra->boost = 0;
+	ra->stride = 0;
+	ra->stride_prev = 0;
+	ra->hits = 0;
+	ra->misses = 0;
+	ra->waits = 0;
 }
 EXPORT_SYMBOL_GPL(file_ra_state_init);
 
@@ -297,6 +305,64 @@ static unsigned long get_next_ra_size(struct file_ra_state *ra,
 	return min(newsize, max);
 }
 
+/*
+ * The window of a sequential reader may grow past ra_pages, up to
+ * ra_pages << RA_MAX_BOOST, when the reader keeps catching up with the
+ * readahead I/O or consumes more than that in RA_LOOKAHEAD_TIME.  Media
+ * players reading several streams from eMMC then stay ahead of the card
+ * latency without raising read_ahead_kb for everybody.
+ */
+#define RA_MAX_BOOST		2
+#define RA_LOOKAHEAD_TIME	max(HZ/10, 1)
+
+static unsigned long ra_max_pages(struct file_ra_state *ra)
+{
+	return max_sane_readahead(ra->ra_pages << ra->boost);
+}
+
+/*
+ * The reader has consumed the last window of ra->size pages since
+ * ra->stamp.  Make the next window, @size after the usual ramp up, last
+ * at least RA_LOOKAHEAD_TIME at that rate, and adjust the boost.
+ */
+static unsigned long get_rate_ra_size(struct file_ra_state *ra,
+				      unsigned long size, unsigned long *max)
+{
+	unsigned long elapsed = max(jiffies - ra->stamp, 1UL);
+	unsigned long need = ra->size * RA_LOOKAHEAD_TIME / elapsed;
+
+	if (need > *max && ra->boost < RA_MAX_BOOST) {
+		ra->boost++;
+		*max = ra_max_pages(ra);
+	} else if (ra->boost && need < ra->ra_pages / 2) {
+		ra->boost--;
+		*max = ra_max_pages(ra);
+	}
+
+	return min(max(size, need), *max);
+}
+
+/*
+ * Strided reads: a reader stepping through the file by a constant stride
+ * larger than its reads, e.g. through the interleaved tracks of a media
+ * container, looks random.  Detect it and return true when the chunk one
+ * stride ahead should be read along with the current one.
+ */
+static bool ra_strided(struct file_ra_state *ra, pgoff_t offset,
+		       unsigned long req_size, unsigned long max)
+{
+	pgoff_t prev = ra->stride_prev;
+	bool strided;
+
+	strided = offset > prev && offset - prev == ra->stride &&
+		  ra->stride > req_size;
+
+	ra->stride = offset > prev && offset - prev <= max ? offset - prev : 0;
+	ra->stride_prev = offset;
+
+	return strided;
+}
+
 /*
  * On-demand readahead design.
  *
@@ -327,6 +393,10 @@ static unsigned long get_next_ra_size(struct file_ra_state *ra,
  * for sequential patterns. Hence interleaved reads might be served as
  * sequential ones.
  *
+ * Strided readers get the chunk one stride ahead read with the current
+ * one and marked with PG_readahead, so that hitting the marker reads the
+ * next one, see ra_strided().
+ *
  * There is a special-case: if the first page which the application tries to
  * read happens to be the first page of the file, it is assumed that a linear
  * read is about to happen and the window is immediately set to the initial size
@@ -398,7 +468,8 @@ ondemand_readahead(struct address_space *mapping,
 		   bool hit_readahead_marker, pgoff_t offset,
 		   unsigned long req_size)
 {
-	unsigned long max = max_sane_readahead(ra->ra_pages);
+	unsigned long max = ra_max_pages(ra);
+	unsigned long ret;
 
 	/*
 	 * start of file
@@ -413,7 +484,7 @@ ondemand_readahead(struct address_space *mapping,
 	if ((offset == (ra->start + ra->size - ra->async_size) ||
 	     offset == (ra->start + ra->size))) {
 		ra->start += ra->size;
-		ra->size = get_next_ra_size(ra, max);
+		ra->size = get_rate_ra_size(ra, get_next_ra_size(ra, max), &max);
 		ra->async_size = ra->size;
 		goto readit;
 	}
@@ -427,6 +498,12 @@ ondemand_readahead(struct address_space *mapping,
 	if (hit_readahead_marker) {
 		pgoff_t start;
 
+		/* next chunk of a strided reader */
+		if (ra->stride && offset == ra->stride_prev + ra->stride &&
+		    ra_strided(ra, offset, req_size, max))
+			return __do_page_cache_readahead(mapping, filp,
+					offset + ra->stride, req_size, req_size);
+
 		rcu_read_lock();
 		start = radix_tree_next_hole(&mapping->page_tree, offset+1,max);
 		rcu_read_unlock();
@@ -465,7 +542,11 @@ ondemand_readahead(struct address_space *mapping,
 	 * standalone, small random read
 	 * Read as is, and do not pollute the readahead state.
 	 */
-	return __do_page_cache_readahead(mapping, filp, offset, req_size, 0);
+	ret = __do_page_cache_readahead(mapping, filp, offset, req_size, 0);
+	if (ra_strided(ra, offset, req_size, max))
+		__do_page_cache_readahead(mapping, filp, offset + ra->stride,
+					  req_size, req_size);
+	return ret;
 
 initial_readahead:
 	ra->start = offset;
@@ -483,6 +564,7 @@ readit:
 		ra->size += ra->async_size;
 	}
 
+	ra->stamp = jiffies;
 	return ra_submit(ra, mapping, filp);
 }
 
@@ -562,3 +644,19 @@ page_cache_async_readahead(struct address_space *mapping,
 	ondemand_readahead(mapping, ra, filp, true, offset, req_size);
 }
 EXPORT_SYMBOL_GPL(page_cache_async_readahead);
+
+/**
+ * page_cache_readahead_wait - the reader caught up with readahead I/O
+ * @ra: file_ra_state which holds the readahead state
+ *
+ * Called when a read finds a page in the page cache which is not uptodate
+ * yet: the readahead was submitted too late to hide the device latency.
+ * Let the window of this file grow further.
+ */
+void page_cache_readahead_wait(struct file_ra_state *ra)
+{
+	ra->waits++;
+	if (ra->boost < RA_MAX_BOOST)
+		ra->boost++;
+}
+EXPORT_SYMBOL_GPL(page_cache_readahead_wait);
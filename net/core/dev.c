@@ -2806,6 +2806,9 @@ static int enqueue_to_backlog(struct sk_buff *skb, int cpu,
 
 	local_irq_save(flags);
 
+	if (cpu != smp_processor_id())
+		__get_cpu_var(softnet_data).steered_rps++;
+
 	rps_lock(sd);
 	if (skb_queue_len(&sd->input_pkt_queue) <= netdev_max_backlog) {
 		if (skb_queue_len(&sd->input_pkt_queue)) {
@@ -3767,6 +3770,7 @@ static void net_rx_action(struct softirq_action *h)
 	struct softnet_data *sd = &__get_cpu_var(softnet_data);
 	unsigned long time_limit = jiffies + 2;
 	int budget = netdev_budget;
+	u64 start = local_clock();
 	void *have;
 
 	local_irq_disable();
@@ -3830,6 +3834,7 @@ static void net_rx_action(struct softirq_action *h)
 		netpoll_poll_unlock(have);
 	}
 out:
+	sd->net_rx_time += local_clock() - start;
 	net_rps_action_and_irq_enable(sd);
 
 #ifdef CONFIG_NET_DMA
@@ -4076,14 +4081,25 @@ static void softnet_seq_stop(struct seq_file *seq, void *v)
 {
 }
 
+/*
+ * One line per CPU: packets processed, packets dropped because the
+ * backlog was full, times net_rx_action() ran out of budget, five unused
+ * columns, transmit lock collisions, RPS IPIs received, packets queued
+ * to the backlog of another CPU, microseconds spent in net_rx_action()
+ * and the current backlog length.
+ */
 static int softnet_seq_show(struct seq_file *seq, void *v)
 {
 	struct softnet_data *sd = v;
 
-	seq_printf(seq, "%08x %08x %08x %08x %08x %08x %08x %08x %08x %08x\n",
+	seq_printf(seq, "%08x %08x %08x %08x %08x %08x %08x %08x %08x %08x "
+		   "%08x %08x %08x\n",
 		   sd->processed, sd->dropped, sd->time_squeeze, 0,
 		   0, 0, 0, 0, /* was fastroute */
-		   sd->cpu_collision, sd->received_rps);
+		   sd->cpu_collision, sd->received_rps, sd->steered_rps,
+		   (unsigned int)div_u64(sd->net_rx_time, NSEC_PER_USEC),
+		   skb_queue_len(&sd->input_pkt_queue) +
+		   skb_queue_len(&sd->process_queue));
 	return 0;
 }
 
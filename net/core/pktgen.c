@@ -231,6 +231,30 @@ struct flow_state {
 /* flow flag bits */
 #define F_INIT   (1<<0)		/* flow has been initialized */
 
+#define PKTGEN_LAT_BUCKETS	20	/* log2 of the latency in usec */
+
+/*
+ * Receive side of a test: our packets that come back on rx_dev, e.g.
+ * from a MAC in loopback, are recognized by the pktgen header and timed
+ * against the send timestamp in it.
+ */
+struct pktgen_rx {
+	struct packet_type pt;	/* bound to rx_dev, holds a reference */
+	spinlock_t lock;
+	__u64 pkts;
+	__u64 bytes;
+	__u64 lost;		/* gaps in the sequence numbers */
+	__u64 reordered;	/* arrived after a later sequence number */
+	__u32 next_seq;
+	ktime_t first_rx;
+	ktime_t last_rx;
+	u64 lat_min;		/* nano-seconds */
+	u64 lat_max;
+	u64 lat_sum;
+	__u64 lat_hist[PKTGEN_LAT_BUCKETS];
+	struct rcu_head rcu;
+};
+
 struct pktgen_dev {
 	/*
 	 * Try to keep frequent/infrequent used vars. separated.
@@ -372,6 +396,7 @@ struct pktgen_dev {
 				  * started as it used to do.)
 				  */
 	char odevname[32];
+	struct pktgen_rx *rx;	/* set by rx_dev, under the if_lock */
 	struct flow_state *flows;
 	unsigned cflows;	/* Concurrent flows (config) */
 	unsigned lflow;		/* Flow length  (config) */
@@ -527,6 +552,220 @@ static const struct file_operations pktgen_fops = {
 	.release = single_release,
 };
 
+static int pktgen_rcv(struct sk_buff *skb, struct net_device *dev,
+		      struct packet_type *pt, struct net_device *orig_dev)
+{
+	struct pktgen_rx *rx = container_of(pt, struct pktgen_rx, pt);
+	ktime_t now = ktime_get_real();
+	struct pktgen_hdr _pgh;
+	const struct pktgen_hdr *pgh;
+	unsigned int off;
+	s64 lat;
+	u32 seq;
+	int slot;
+
+	if (skb->pkt_type == PACKET_OUTGOING)
+		goto out;
+
+	switch (skb->protocol) {
+	case htons(ETH_P_IP): {
+		struct iphdr _iph;
+		const struct iphdr *iph;
+
+		iph = skb_header_pointer(skb, 0, sizeof(_iph), &_iph);
+		if (!iph || iph->protocol != IPPROTO_UDP)
+			goto out;
+		off = iph->ihl * 4;
+		break;
+	}
+	case htons(ETH_P_IPV6): {
+		struct ipv6hdr _ip6h;
+		const struct ipv6hdr *ip6h;
+
+		ip6h = skb_header_pointer(skb, 0, sizeof(_ip6h), &_ip6h);
+		if (!ip6h || ip6h->nexthdr != IPPROTO_UDP)
+			goto out;
+		off = sizeof(*ip6h);
+		break;
+	}
+	default:
+		goto out;
+	}
+
+	pgh = skb_header_pointer(skb, off + sizeof(struct udphdr),
+				 sizeof(_pgh), &_pgh);
+	if (!pgh || pgh->pgh_magic != htonl(PKTGEN_MAGIC))
+		goto out;
+
+	seq = ntohl(pgh->seq_num);
+	lat = ktime_to_ns(ktime_sub(now, ktime_set(ntohl(pgh->tv_sec),
+				ntohl(pgh->tv_usec) * NSEC_PER_USEC)));
+	/* the send timestamp only has usec resolution */
+	if (lat < 0)
+		lat = 0;
+	slot = min_t(int, fls64(div_u64(lat, NSEC_PER_USEC)),
+		     PKTGEN_LAT_BUCKETS - 1);
+
+	spin_lock(&rx->lock);
+	if (!rx->pkts) {
+		rx->first_rx = now;
+		rx->next_seq = seq;
+		rx->lat_min = lat;
+	}
+	rx->pkts++;
+	rx->bytes += skb->len + skb->mac_len;
+	rx->last_rx = now;
+
+	if ((s32)(seq - rx->next_seq) >= 0) {
+		rx->lost += seq - rx->next_seq;
+		rx->next_seq = seq + 1;
+	} else {
+		rx->reordered++;
+		if (rx->lost)
+			rx->lost--;
+	}
+
+	if (lat < rx->lat_min)
+		rx->lat_min = lat;
+	if (lat > rx->lat_max)
+		rx->lat_max = lat;
+	rx->lat_sum += lat;
+	rx->lat_hist[slot]++;
+	spin_unlock(&rx->lock);
+out:
+	kfree_skb(skb);
+	return 0;
+}
+
+/*
+ * Called with the thread's if_lock held: pktgen_rx_setup() and
+ * pktgen_rx_unregister() take it, and pktgen_remove_device() is only
+ * called under it.  The handler may still be running on another CPU, so
+ * the statistics are freed after a grace period.
+ */
+static void pktgen_rx_detach(struct pktgen_dev *pkt_dev)
+{
+	struct pktgen_rx *rx = pkt_dev->rx;
+
+	if (!rx)
+		return;
+
+	rcu_assign_pointer(pkt_dev->rx, NULL);
+	__dev_remove_pack(&rx->pt);
+	dev_put(rx->pt.dev);
+	kfree_rcu(rx, rcu);
+}
+
+/* Start receiving on ifname, or stop if it is empty */
+static int pktgen_rx_setup(struct pktgen_dev *pkt_dev, const char *ifname)
+{
+	struct pktgen_thread *t = pkt_dev->pg_thread;
+	struct pktgen_rx *rx = NULL;
+	struct net_device *dev;
+
+	if (ifname[0]) {
+		dev = dev_get_by_name(&init_net, ifname);
+		if (!dev)
+			return -ENODEV;
+
+		rx = kzalloc_node(sizeof(*rx), GFP_KERNEL, pkt_dev->node);
+		if (!rx) {
+			dev_put(dev);
+			return -ENOMEM;
+		}
+		spin_lock_init(&rx->lock);
+		rx->pt.type = htons(ETH_P_ALL);
+		rx->pt.dev = dev;
+		rx->pt.func = pktgen_rcv;
+	}
+
+	if_lock(t);
+	pktgen_rx_detach(pkt_dev);
+	if (rx) {
+		dev_add_pack(&rx->pt);
+		rcu_assign_pointer(pkt_dev->rx, rx);
+	}
+	if_unlock(t);
+
+	return 0;
+}
+
+static void pktgen_rx_clear(struct pktgen_dev *pkt_dev)
+{
+	struct pktgen_rx *rx;
+
+	rcu_read_lock();
+	rx = rcu_dereference(pkt_dev->rx);
+	if (rx) {
+		spin_lock_bh(&rx->lock);
+		memset(&rx->pkts, 0,
+		       offsetof(struct pktgen_rx, rcu) -
+		       offsetof(struct pktgen_rx, pkts));
+		spin_unlock_bh(&rx->lock);
+	}
+	rcu_read_unlock();
+}
+
+static void pktgen_rx_show(struct seq_file *seq,
+			   const struct pktgen_dev *pkt_dev)
+{
+	struct pktgen_rx *rx;
+	__u64 hist[PKTGEN_LAT_BUCKETS];
+	__u64 pkts, bytes, lost, reordered, pps = 0, bps = 0;
+	u64 lat_min, lat_max, lat_avg = 0;
+	s64 elapsed;
+	int i;
+
+	rcu_read_lock();
+	rx = rcu_dereference(pkt_dev->rx);
+	if (!rx) {
+		rcu_read_unlock();
+		return;
+	}
+
+	spin_lock_bh(&rx->lock);
+	pkts = rx->pkts;
+	bytes = rx->bytes;
+	lost = rx->lost;
+	reordered = rx->reordered;
+	lat_min = rx->lat_min;
+	lat_max = rx->lat_max;
+	if (pkts)
+		lat_avg = div64_u64(rx->lat_sum, pkts);
+	elapsed = ktime_to_ns(ktime_sub(rx->last_rx, rx->first_rx));
+	memcpy(hist, rx->lat_hist, sizeof(hist));
+	spin_unlock_bh(&rx->lock);
+
+	seq_printf(seq, "Received on %s:\n", rx->pt.dev->name);
+	rcu_read_unlock();
+
+	/* rates between the first and the last packet received */
+	if (pkts > 1 && elapsed > 0) {
+		pps = div64_u64((pkts - 1) * NSEC_PER_SEC, elapsed);
+		bps = div64_u64(bytes * 8 * NSEC_PER_SEC, elapsed);
+	}
+
+	seq_printf(seq,
+		   "     pkts: %llu  bytes: %llu  lost: %llu  reordered: %llu\n",
+		   (unsigned long long)pkts, (unsigned long long)bytes,
+		   (unsigned long long)lost, (unsigned long long)reordered);
+	seq_printf(seq, "     %llupps %lluMb/sec (%llubps)\n",
+		   (unsigned long long)pps,
+		   (unsigned long long)div_u64(bps, 1000000),
+		   (unsigned long long)bps);
+	seq_printf(seq, "     latency: min %lluns  avg %lluns  max %lluns\n",
+		   (unsigned long long)lat_min, (unsigned long long)lat_avg,
+		   (unsigned long long)lat_max);
+
+	/* each slot counts from its lower bound to the next one, in usec */
+	seq_puts(seq, "     lat_hist:");
+	for (i = 0; i < PKTGEN_LAT_BUCKETS; i++)
+		if (hist[i])
+			seq_printf(seq, " %lu:%llu", i ? 1UL << (i - 1) : 0,
+				   (unsigned long long)hist[i]);
+	seq_puts(seq, "\n");
+}
+
 static int pktgen_if_show(struct seq_file *seq, void *v)
 {
 	const struct pktgen_dev *pkt_dev = seq->private;
@@ -717,6 +956,8 @@ static int pktgen_if_show(struct seq_file *seq, void *v)
 	else
 		seq_printf(seq, "Result: Idle\n");
 
+	pktgen_rx_show(seq, pkt_dev);
+
 	return 0;
 }
 
@@ -1457,6 +1698,26 @@ static ssize_t pktgen_if_write(struct file *file,
 		return count;
 	}
 
+	if (!strcmp(name, "rx_dev")) {
+		int ret;
+
+		len = strn_len(&user_buffer[i], IFNAMSIZ - 1);
+		if (len < 0)
+			return len;
+
+		if (copy_from_user(buf, &user_buffer[i], len))
+			return -EFAULT;
+		buf[len] = 0;
+		i += len;
+
+		ret = pktgen_rx_setup(pkt_dev, buf);
+		if (ret)
+			return ret;
+
+		sprintf(pg_result, "OK: rx_dev=%s", buf);
+		return count;
+	}
+
 	if (!strcmp(name, "clear_counters")) {
 		pktgen_clear_counters(pkt_dev);
 		sprintf(pg_result, "OK: Clearing counters.\n");
@@ -1927,6 +2188,21 @@ static void pktgen_change_name(struct net_device *dev)
 	}
 }
 
+static void pktgen_rx_unregister(struct net_device *dev)
+{
+	struct pktgen_thread *t;
+
+	list_for_each_entry(t, &pktgen_threads, th_list) {
+		struct pktgen_dev *pkt_dev;
+
+		if_lock(t);
+		list_for_each_entry(pkt_dev, &t->if_list, list)
+			if (pkt_dev->rx && pkt_dev->rx->pt.dev == dev)
+				pktgen_rx_detach(pkt_dev);
+		if_unlock(t);
+	}
+}
+
 static int pktgen_device_event(struct notifier_block *unused,
 			       unsigned long event, void *ptr)
 {
@@ -1945,6 +2221,7 @@ static int pktgen_device_event(struct notifier_block *unused,
 		break;
 
 	case NETDEV_UNREGISTER:
+		pktgen_rx_unregister(dev);
 		pktgen_mark_device(dev->name);
 		break;
 	}
@@ -2985,6 +3262,7 @@ static void pktgen_clear_counters(struct pktgen_dev *pkt_dev)
 	pkt_dev->sofar = 0;
 	pkt_dev->tx_bytes = 0;
 	pkt_dev->errors = 0;
+	pktgen_rx_clear(pkt_dev);
 }
 
 /* Set up structure for sending pkts, clear counters */
@@ -3670,6 +3948,7 @@ static void _rem_dev_from_if_list(struct pktgen_thread *t,
 	}
 }
 
+/* Called with the thread's if_lock held */
 static int pktgen_remove_device(struct pktgen_thread *t,
 				struct pktgen_dev *pkt_dev)
 {
@@ -3687,6 +3966,7 @@ static int pktgen_remove_device(struct pktgen_thread *t,
 		dev_put(pkt_dev->odev);
 		pkt_dev->odev = NULL;
 	}
+	pktgen_rx_detach(pkt_dev);
 
 	/* And update the thread if_list */
 
@@ -3771,6 +4051,9 @@ static void __exit pg_cleanup(void)
 		kfree(t);
 	}
 
+	/* let the receive handlers of removed devices finish */
+	synchronize_net();
+
 	/* Un-register us from receiving netdevice events */
 	unregister_netdevice_notifier(&pktgen_notifier_block);
 
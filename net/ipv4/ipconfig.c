@@ -1338,6 +1338,12 @@ static int __init wait_for_devices(void)
 {
 	int i;
 
+	/*
+	 * Network drivers may be probing asynchronously (driver_async_probe=);
+	 * wait for them rather than polling once a second.
+	 */
+	wait_for_device_probe();
+
 	for (i = 0; i < DEVICE_WAIT_MAX; i++) {
 		struct net_device *dev;
 		int found = 0;
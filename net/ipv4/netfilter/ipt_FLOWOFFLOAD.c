@@ -0,0 +1,798 @@
+/*
+ * Software flow offload for forwarded IPv4 connections
+ *
+ * Connections that hit the FLOWOFFLOAD target once they are established
+ * are entered in a flow table.  A PRE_ROUTING hook that runs ahead of
+ * defragmentation and connection tracking looks up the TCP and UDP packets
+ * in it; on a hit, the packet gets the NAT mangling of its connection and
+ * its TTL decremented and goes straight to the neighbour of the cached
+ * route.  Conntrack, the routing decision, the iptables chains and NAT are
+ * all skipped.  Packets the fast path does not handle (IP options,
+ * fragments, TTL expiry, packets over the MTU, TCP FIN and RST) take the
+ * normal path; a FIN or RST also ends the offload of its connection.
+ *
+ * While a connection is offloaded, its conntrack entry is kept alive by the
+ * flow and gets the packet counts of the flow.  Flows idle for
+ * FLOW_OFFLOAD_TIMEOUT, of a dead conntrack or of a device going down are
+ * removed by a periodic worker.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#include <linux/module.h>
+#include <linux/skbuff.h>
+#include <linux/slab.h>
+#include <linux/jhash.h>
+#include <linux/random.h>
+#include <linux/ip.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
+#include <linux/netdevice.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/workqueue.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter_ipv4.h>
+#include <linux/netfilter/x_tables.h>
+#include <net/ip.h>
+#include <net/route.h>
+#include <net/checksum.h>
+#include <net/neighbour.h>
+#include <net/netfilter/nf_conntrack.h>
+#include <net/netfilter/nf_conntrack_acct.h>
+#include <net/netfilter/nf_conntrack_helper.h>
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Xtables: software flow offload of forwarded connections");
+
+#define FLOW_OFFLOAD_HASH_BITS		10
+#define FLOW_OFFLOAD_HASH_SIZE		(1 << FLOW_OFFLOAD_HASH_BITS)
+#define FLOW_OFFLOAD_TIMEOUT		(30 * HZ)
+#define FLOW_OFFLOAD_GC_INTERVAL	HZ
+
+static unsigned int flow_offload_max __read_mostly = 4096;
+module_param_named(max_flows, flow_offload_max, uint, 0644);
+MODULE_PARM_DESC(max_flows, "maximum number of offloaded connections");
+
+struct flow_offload_tuple {
+	__be32				src;
+	__be32				dst;
+	__be16				sport;
+	__be16				dport;
+	u8				proto;
+	const struct net_device		*in;
+};
+
+/* One direction of an offloaded connection */
+struct flow_offload_tuple_hash {
+	struct hlist_node		node;
+	struct flow_offload_tuple	tuple;
+	u8				dir;
+
+	/* the addresses and ports once NATed */
+	__be32				nat_src;
+	__be32				nat_dst;
+	__be16				nat_sport;
+	__be16				nat_dport;
+
+	struct dst_entry		*dst;
+	unsigned int			mtu;
+
+	/* folded into the conntrack counters by the gc worker */
+	atomic64_t			packets;
+	atomic64_t			bytes;
+};
+
+enum flow_offload_flags {
+	FLOW_OFFLOAD_TEARDOWN,
+};
+
+struct flow_offload {
+	struct flow_offload_tuple_hash	tuplehash[IP_CT_DIR_MAX];
+	struct nf_conn			*ct;
+	u32				timeout;
+	unsigned long			flags;
+	struct rcu_head			rcu;
+};
+
+struct flow_offload_stat {
+	unsigned int			hit;
+	unsigned int			slowpath;
+	unsigned int			insert;
+	unsigned int			delete;
+};
+
+static struct hlist_head flow_offload_hash[FLOW_OFFLOAD_HASH_SIZE];
+static DEFINE_SPINLOCK(flow_offload_lock);
+static unsigned int flow_offload_count;
+static u32 flow_offload_hash_rnd __read_mostly;
+static struct delayed_work flow_offload_gc_work;
+static struct flow_offload_stat __percpu *flow_offload_stat;
+
+#define FLOW_OFFLOAD_STAT_INC(field) \
+	__this_cpu_inc(flow_offload_stat->field)
+
+static inline struct flow_offload *
+flow_offload_from_tuple(struct flow_offload_tuple_hash *th)
+{
+	return container_of(th, struct flow_offload, tuplehash[th->dir]);
+}
+
+static inline unsigned int
+flow_offload_hashfn(const struct flow_offload_tuple *tuple)
+{
+	return jhash_3words((__force u32)tuple->src, (__force u32)tuple->dst,
+			    ((__force u32)tuple->sport << 16 |
+			     (__force u32)tuple->dport) ^ tuple->proto,
+			    flow_offload_hash_rnd) &
+	       (FLOW_OFFLOAD_HASH_SIZE - 1);
+}
+
+static inline bool flow_offload_tuple_equal(const struct flow_offload_tuple *a,
+					    const struct flow_offload_tuple *b)
+{
+	return a->src == b->src && a->dst == b->dst &&
+	       a->sport == b->sport && a->dport == b->dport &&
+	       a->proto == b->proto && a->in == b->in;
+}
+
+/* Called under rcu_read_lock() or flow_offload_lock */
+static struct flow_offload_tuple_hash *
+flow_offload_lookup(const struct flow_offload_tuple *tuple)
+{
+	struct flow_offload_tuple_hash *th;
+	struct hlist_node *n;
+
+	hlist_for_each_entry_rcu(th, n,
+				 &flow_offload_hash[flow_offload_hashfn(tuple)],
+				 node) {
+		if (flow_offload_tuple_equal(&th->tuple, tuple))
+			return th;
+	}
+	return NULL;
+}
+
+static void flow_offload_free_rcu(struct rcu_head *head)
+{
+	struct flow_offload *flow = container_of(head, struct flow_offload, rcu);
+
+	dst_release(flow->tuplehash[IP_CT_DIR_ORIGINAL].dst);
+	dst_release(flow->tuplehash[IP_CT_DIR_REPLY].dst);
+	nf_ct_put(flow->ct);
+	kfree(flow);
+}
+
+/* Add the packets forwarded since the last call to the conntrack counters */
+static void flow_offload_fold_acct(struct flow_offload *flow)
+{
+	struct nf_conn_counter *acct = nf_conn_acct_find(flow->ct);
+	int dir;
+
+	for (dir = 0; dir < IP_CT_DIR_MAX; dir++) {
+		struct flow_offload_tuple_hash *th = &flow->tuplehash[dir];
+		u64 packets = atomic64_xchg(&th->packets, 0);
+		u64 bytes = atomic64_xchg(&th->bytes, 0);
+
+		if (!acct || !packets)
+			continue;
+
+		spin_lock(&flow->ct->lock);
+		acct[dir].packets += packets;
+		acct[dir].bytes += bytes;
+		spin_unlock(&flow->ct->lock);
+	}
+}
+
+/* Called with flow_offload_lock held */
+static void flow_offload_del(struct flow_offload *flow)
+{
+	hlist_del_rcu(&flow->tuplehash[IP_CT_DIR_ORIGINAL].node);
+	hlist_del_rcu(&flow->tuplehash[IP_CT_DIR_REPLY].node);
+	flow_offload_count--;
+	FLOW_OFFLOAD_STAT_INC(delete);
+
+	flow_offload_fold_acct(flow);
+	call_rcu(&flow->rcu, flow_offload_free_rcu);
+}
+
+static void flow_offload_teardown(struct flow_offload *flow)
+{
+	set_bit(FLOW_OFFLOAD_TEARDOWN, &flow->flags);
+}
+
+static bool flow_offload_uses_dev(const struct flow_offload *flow,
+				  const struct net_device *dev)
+{
+	int dir;
+
+	for (dir = 0; dir < IP_CT_DIR_MAX; dir++) {
+		const struct flow_offload_tuple_hash *th = &flow->tuplehash[dir];
+
+		if (th->tuple.in == dev || th->dst->dev == dev)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Remove the flows that are torn down, idle, of a dying conntrack or
+ * going through @dev, if given, or all of them with @all.  The others
+ * keep their conntrack alive.
+ */
+static void flow_offload_gc_table(const struct net_device *dev, bool all)
+{
+	struct flow_offload_tuple_hash *th;
+	struct flow_offload *flow;
+	struct hlist_node *n;
+	unsigned int i;
+
+	spin_lock_bh(&flow_offload_lock);
+	for (i = 0; i < FLOW_OFFLOAD_HASH_SIZE; i++) {
+restart:
+		hlist_for_each_entry(th, n, &flow_offload_hash[i], node) {
+			if (th->dir != IP_CT_DIR_ORIGINAL)
+				continue;
+			flow = flow_offload_from_tuple(th);
+
+			if (all ||
+			    test_bit(FLOW_OFFLOAD_TEARDOWN, &flow->flags) ||
+			    nf_ct_is_dying(flow->ct) ||
+			    (s32)(flow->timeout - nfct_time_stamp) <= 0 ||
+			    (dev && flow_offload_uses_dev(flow, dev))) {
+				flow_offload_del(flow);
+				goto restart;
+			}
+
+			flow_offload_fold_acct(flow);
+			if ((s32)(flow->timeout - flow->ct->timeout) > 0)
+				flow->ct->timeout = flow->timeout;
+		}
+	}
+	spin_unlock_bh(&flow_offload_lock);
+}
+
+static void flow_offload_gc(struct work_struct *work)
+{
+	flow_offload_gc_table(NULL, false);
+	schedule_delayed_work(&flow_offload_gc_work, FLOW_OFFLOAD_GC_INTERVAL);
+}
+
+static void flow_offload_fill_tuple(struct flow_offload_tuple *tuple,
+				    const struct nf_conn *ct,
+				    enum ip_conntrack_dir dir,
+				    const struct net_device *in)
+{
+	const struct nf_conntrack_tuple *t = &ct->tuplehash[dir].tuple;
+
+	tuple->src = t->src.u3.ip;
+	tuple->dst = t->dst.u3.ip;
+	tuple->sport = t->src.u.all;
+	tuple->dport = t->dst.u.all;
+	tuple->proto = t->dst.protonum;
+	tuple->in = in;
+}
+
+static void flow_offload_fill_dir(struct flow_offload *flow,
+				  const struct nf_conn *ct,
+				  enum ip_conntrack_dir dir,
+				  const struct net_device *in,
+				  struct dst_entry *dst)
+{
+	const struct nf_conntrack_tuple *rt = &ct->tuplehash[!dir].tuple;
+	struct flow_offload_tuple_hash *th = &flow->tuplehash[dir];
+
+	flow_offload_fill_tuple(&th->tuple, ct, dir, in);
+	th->dir = dir;
+
+	/* packets leave as the inverse of the other direction's tuple */
+	th->nat_src = rt->dst.u3.ip;
+	th->nat_dst = rt->src.u3.ip;
+	th->nat_sport = rt->dst.u.all;
+	th->nat_dport = rt->src.u.all;
+
+	th->dst = dst;
+	th->mtu = dst_mtu(dst);
+}
+
+static int flow_offload_add(struct nf_conn *ct, enum ip_conntrack_info ctinfo,
+			    struct sk_buff *skb,
+			    const struct xt_action_param *par)
+{
+	enum ip_conntrack_dir dir = CTINFO2DIR(ctinfo);
+	struct flow_offload_tuple tuple;
+	struct flow_offload *flow;
+	struct rtable *rt;
+	struct flowi4 fl4;
+
+	if (skb_rtable(skb)->rt_type != RTN_UNICAST)
+		return -EINVAL;
+
+	/*
+	 * The packets of an offloaded flow that still come this way (TTL
+	 * expiry, oversized, racing the insertion) must not cost a route
+	 * lookup and an allocation each.  xt targets run under
+	 * rcu_read_lock(); the check is repeated under the lock below.
+	 */
+	flow_offload_fill_tuple(&tuple, ct, dir, par->in);
+	if (ACCESS_ONCE(flow_offload_count) >= flow_offload_max ||
+	    flow_offload_lookup(&tuple))
+		return -EEXIST;
+
+	/* the route back to the sender of this packet */
+	memset(&fl4, 0, sizeof(fl4));
+	fl4.daddr = ct->tuplehash[dir].tuple.src.u3.ip;
+	rt = ip_route_output_key(dev_net(par->in), &fl4);
+	if (IS_ERR(rt))
+		return PTR_ERR(rt);
+	if (rt->rt_type != RTN_UNICAST || rt->dst.dev != par->in) {
+		/* asymmetric routing: leave it to the slow path */
+		ip_rt_put(rt);
+		return -EINVAL;
+	}
+
+	flow = kzalloc(sizeof(*flow), GFP_ATOMIC);
+	if (flow == NULL) {
+		ip_rt_put(rt);
+		return -ENOMEM;
+	}
+
+	flow_offload_fill_dir(flow, ct, dir, par->in, dst_clone(skb_dst(skb)));
+	flow_offload_fill_dir(flow, ct, !dir, par->out, &rt->dst);
+	atomic_inc(&ct->ct_general.use);
+	flow->ct = ct;
+	flow->timeout = nfct_time_stamp + FLOW_OFFLOAD_TIMEOUT;
+
+	spin_lock_bh(&flow_offload_lock);
+	if (flow_offload_count >= flow_offload_max ||
+	    flow_offload_lookup(&flow->tuplehash[IP_CT_DIR_ORIGINAL].tuple) ||
+	    flow_offload_lookup(&flow->tuplehash[IP_CT_DIR_REPLY].tuple)) {
+		spin_unlock_bh(&flow_offload_lock);
+		flow_offload_free_rcu(&flow->rcu);
+		return -EEXIST;
+	}
+	hlist_add_head_rcu(&flow->tuplehash[IP_CT_DIR_ORIGINAL].node,
+			   &flow_offload_hash[flow_offload_hashfn(
+				&flow->tuplehash[IP_CT_DIR_ORIGINAL].tuple)]);
+	hlist_add_head_rcu(&flow->tuplehash[IP_CT_DIR_REPLY].node,
+			   &flow_offload_hash[flow_offload_hashfn(
+				&flow->tuplehash[IP_CT_DIR_REPLY].tuple)]);
+	flow_offload_count++;
+	FLOW_OFFLOAD_STAT_INC(insert);
+	spin_unlock_bh(&flow_offload_lock);
+
+	/*
+	 * TCP window tracking does not see the offloaded packets: don't let
+	 * it judge the ones that come back through the slow path.
+	 */
+	if (nf_ct_protonum(ct) == IPPROTO_TCP) {
+		spin_lock_bh(&ct->lock);
+		ct->proto.tcp.seen[0].flags |= IP_CT_TCP_FLAG_BE_LIBERAL;
+		ct->proto.tcp.seen[1].flags |= IP_CT_TCP_FLAG_BE_LIBERAL;
+		spin_unlock_bh(&ct->lock);
+	}
+	return 0;
+}
+
+static void flow_offload_nat_addr(struct sk_buff *skb, struct iphdr *iph,
+				  __be32 *addr, __be32 new, __sum16 *check)
+{
+	if (check)
+		inet_proto_csum_replace4(check, skb, *addr, new, 1);
+	csum_replace4(&iph->check, *addr, new);
+	*addr = new;
+}
+
+static void flow_offload_nat_port(struct sk_buff *skb, __be16 *port,
+				  __be16 new, __sum16 *check)
+{
+	if (check)
+		inet_proto_csum_replace2(check, skb, *port, new, 0);
+	*port = new;
+}
+
+static void flow_offload_nat(struct sk_buff *skb, struct iphdr *iph,
+			     __be16 *ports,
+			     const struct flow_offload_tuple_hash *th)
+{
+	__sum16 *check = NULL;
+
+	if (iph->protocol == IPPROTO_TCP)
+		check = &((struct tcphdr *)ports)->check;
+	else if (((struct udphdr *)ports)->check ||
+		 skb->ip_summed == CHECKSUM_PARTIAL)
+		check = &((struct udphdr *)ports)->check;
+
+	if (iph->saddr != th->nat_src)
+		flow_offload_nat_addr(skb, iph, &iph->saddr, th->nat_src, check);
+	if (iph->daddr != th->nat_dst)
+		flow_offload_nat_addr(skb, iph, &iph->daddr, th->nat_dst, check);
+	if (ports[0] != th->nat_sport)
+		flow_offload_nat_port(skb, &ports[0], th->nat_sport, check);
+	if (ports[1] != th->nat_dport)
+		flow_offload_nat_port(skb, &ports[1], th->nat_dport, check);
+
+	if (iph->protocol == IPPROTO_UDP && check && !*check)
+		*check = CSUM_MANGLED_0;
+}
+
+/* ip_finish_output2() without the multicast and broadcast accounting */
+static int flow_offload_xmit(struct sk_buff *skb)
+{
+	struct dst_entry *dst = skb_dst(skb);
+	struct net_device *dev = dst->dev;
+	unsigned int hh_len = LL_RESERVED_SPACE(dev);
+	struct neighbour *neigh;
+
+	if (unlikely(skb_headroom(skb) < hh_len && dev->header_ops)) {
+		struct sk_buff *skb2;
+
+		skb2 = skb_realloc_headroom(skb, hh_len);
+		kfree_skb(skb);
+		if (skb2 == NULL)
+			return -ENOMEM;
+		skb = skb2;
+	}
+
+	if (dst->hh)
+		return neigh_hh_output(dst->hh, skb);
+
+	neigh = dst_get_neighbour(dst);
+	if (neigh)
+		return neigh->output(skb);
+
+	kfree_skb(skb);
+	return -EINVAL;
+}
+
+struct flow_offload_dst_put {
+	struct rcu_head		rcu;
+	struct dst_entry	*dst;
+};
+
+static void flow_offload_dst_put_rcu(struct rcu_head *head)
+{
+	struct flow_offload_dst_put *put =
+		container_of(head, struct flow_offload_dst_put, rcu);
+
+	dst_release(put->dst);
+	kfree(put);
+}
+
+/*
+ * The route of @th went stale: replace it by a fresh lookup of the same
+ * destination, provided the packets still leave through the same device
+ * (the other direction is keyed on it).  Other CPUs may be using the old
+ * route under rcu_read_lock(), it is released after a grace period.
+ * Returns non zero if the flow has to go.
+ */
+static int flow_offload_refresh_dst(struct flow_offload_tuple_hash *th,
+				    const struct net_device *in)
+{
+	struct flow_offload_dst_put *put;
+	struct dst_entry *old;
+	struct rtable *rt;
+	struct flowi4 fl4;
+
+	put = kmalloc(sizeof(*put), GFP_ATOMIC);
+	if (put == NULL)
+		return -ENOMEM;
+
+	memset(&fl4, 0, sizeof(fl4));
+	fl4.daddr = th->nat_dst;
+	rt = ip_route_output_key(dev_net(in), &fl4);
+	if (IS_ERR(rt)) {
+		kfree(put);
+		return PTR_ERR(rt);
+	}
+
+	spin_lock(&flow_offload_lock);
+	old = th->dst;
+	if (rt->rt_type != RTN_UNICAST || rt->dst.dev != old->dev) {
+		spin_unlock(&flow_offload_lock);
+		ip_rt_put(rt);
+		kfree(put);
+		return -EINVAL;
+	}
+	if (dst_check(old, 0) != NULL) {
+		/* somebody else refreshed it meanwhile */
+		spin_unlock(&flow_offload_lock);
+		ip_rt_put(rt);
+		kfree(put);
+		return 0;
+	}
+	th->mtu = dst_mtu(&rt->dst);
+	rcu_assign_pointer(th->dst, &rt->dst);
+	spin_unlock(&flow_offload_lock);
+
+	put->dst = old;
+	call_rcu(&put->rcu, flow_offload_dst_put_rcu);
+	return 0;
+}
+
+static unsigned int
+flow_offload_hook(unsigned int hooknum, struct sk_buff *skb,
+		  const struct net_device *in, const struct net_device *out,
+		  int (*okfn)(struct sk_buff *))
+{
+	struct flow_offload_tuple_hash *th;
+	struct flow_offload_tuple tuple;
+	struct flow_offload *flow;
+	struct dst_entry *dst;
+	unsigned int thoff, hdrsize;
+	struct iphdr *iph;
+	__be16 *ports;
+
+	if (skb->pkt_type != PACKET_HOST)
+		return NF_ACCEPT;
+
+	iph = ip_hdr(skb);
+	if (iph->ihl != 5 || iph->frag_off & htons(IP_MF | IP_OFFSET))
+		return NF_ACCEPT;
+
+	switch (iph->protocol) {
+	case IPPROTO_TCP:
+		hdrsize = sizeof(struct tcphdr);
+		break;
+	case IPPROTO_UDP:
+		hdrsize = sizeof(struct udphdr);
+		break;
+	default:
+		return NF_ACCEPT;
+	}
+
+	thoff = sizeof(struct iphdr);
+	if (!pskb_may_pull(skb, thoff + hdrsize))
+		return NF_ACCEPT;
+
+	iph = ip_hdr(skb);
+	ports = (__be16 *)(skb_network_header(skb) + thoff);
+
+	tuple.src = iph->saddr;
+	tuple.dst = iph->daddr;
+	tuple.sport = ports[0];
+	tuple.dport = ports[1];
+	tuple.proto = iph->protocol;
+	tuple.in = in;
+
+	/* nf_hook_slow() holds rcu_read_lock() */
+	th = flow_offload_lookup(&tuple);
+	if (th == NULL)
+		return NF_ACCEPT;
+	flow = flow_offload_from_tuple(th);
+
+	if (unlikely(test_bit(FLOW_OFFLOAD_TEARDOWN, &flow->flags)))
+		return NF_ACCEPT;
+
+	if (unlikely(nf_ct_is_dying(flow->ct)))
+		goto teardown;
+
+	/*
+	 * Every IPv4 route has obsolete set, ask the route itself whether
+	 * it is still valid and look up a new one if not.
+	 */
+	if (unlikely(dst_check(th->dst, 0) == NULL) &&
+	    flow_offload_refresh_dst(th, in))
+		goto teardown;
+
+	if (iph->protocol == IPPROTO_TCP) {
+		const struct tcphdr *tcph = (const struct tcphdr *)ports;
+
+		if (unlikely(tcph->fin || tcph->rst))
+			goto teardown;
+	}
+
+	/* ICMP errors and fragmentation are left to the slow path */
+	if (unlikely(iph->ttl <= 1 ||
+		     (skb->len > th->mtu && !skb_is_gso(skb))))
+		goto slowpath;
+
+	if (!skb_make_writable(skb, thoff + hdrsize))
+		return NF_DROP;
+
+	iph = ip_hdr(skb);
+	ports = (__be16 *)(skb_network_header(skb) + thoff);
+	flow_offload_nat(skb, iph, ports, th);
+	ip_decrease_ttl(iph);
+
+	flow->timeout = nfct_time_stamp + FLOW_OFFLOAD_TIMEOUT;
+	atomic64_inc(&th->packets);
+	atomic64_add(skb->len, &th->bytes);
+	FLOW_OFFLOAD_STAT_INC(hit);
+
+	dst = rcu_dereference(th->dst);
+	skb_dst_drop(skb);
+	skb_dst_set(skb, dst_clone(dst));
+	skb->dev = dst->dev;
+	IP_INC_STATS_BH(dev_net(skb->dev), IPSTATS_MIB_OUTFORWDATAGRAMS);
+
+	flow_offload_xmit(skb);
+	return NF_STOLEN;
+
+teardown:
+	flow_offload_teardown(flow);
+slowpath:
+	FLOW_OFFLOAD_STAT_INC(slowpath);
+	return NF_ACCEPT;
+}
+
+static struct nf_hook_ops flow_offload_ops __read_mostly = {
+	.hook		= flow_offload_hook,
+	.owner		= THIS_MODULE,
+	.pf		= NFPROTO_IPV4,
+	.hooknum	= NF_INET_PRE_ROUTING,
+	.priority	= NF_IP_PRI_FIRST,
+};
+
+static unsigned int
+flowoffload_tg(struct sk_buff *skb, const struct xt_action_param *par)
+{
+	enum ip_conntrack_info ctinfo;
+	struct nf_conn_help *help;
+	struct nf_conn *ct;
+
+	ct = nf_ct_get(skb, &ctinfo);
+	if (ct == NULL || nf_ct_is_untracked(ct))
+		return XT_CONTINUE;
+
+	if (ctinfo != IP_CT_ESTABLISHED && ctinfo != IP_CT_ESTABLISHED_REPLY)
+		return XT_CONTINUE;
+
+	switch (nf_ct_protonum(ct)) {
+	case IPPROTO_TCP:
+		if (ct->proto.tcp.state != TCP_CONNTRACK_ESTABLISHED)
+			return XT_CONTINUE;
+		break;
+	case IPPROTO_UDP:
+		break;
+	default:
+		return XT_CONTINUE;
+	}
+
+	/* helpers and sequence number adjustment must see every packet */
+	help = nfct_help(ct);
+	if ((help && rcu_dereference(help->helper)) ||
+	    test_bit(IPS_SEQ_ADJUST_BIT, &ct->status))
+		return XT_CONTINUE;
+
+	flow_offload_add(ct, ctinfo, skb, par);
+	return XT_CONTINUE;
+}
+
+static int flowoffload_tg_check(const struct xt_tgchk_param *par)
+{
+	return nf_ct_l3proto_try_module_get(par->family);
+}
+
+static void flowoffload_tg_destroy(const struct xt_tgdtor_param *par)
+{
+	nf_ct_l3proto_module_put(par->family);
+}
+
+static struct xt_target flowoffload_tg_reg __read_mostly = {
+	.name		= "FLOWOFFLOAD",
+	.family		= NFPROTO_IPV4,
+	.table		= "filter",
+	.hooks		= 1 << NF_INET_FORWARD,
+	.target		= flowoffload_tg,
+	.checkentry	= flowoffload_tg_check,
+	.destroy	= flowoffload_tg_destroy,
+	.me		= THIS_MODULE,
+};
+
+static int flow_offload_netdev_event(struct notifier_block *this,
+				     unsigned long event, void *ptr)
+{
+	struct net_device *dev = ptr;
+
+	if (event == NETDEV_DOWN)
+		flow_offload_gc_table(dev, false);
+
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block flow_offload_netdev_notifier = {
+	.notifier_call	= flow_offload_netdev_event,
+};
+
+#ifdef CONFIG_PROC_FS
+static int flow_offload_stat_show(struct seq_file *seq, void *v)
+{
+	unsigned int hit = 0, slowpath = 0, insert = 0, delete = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		const struct flow_offload_stat *st =
+			per_cpu_ptr(flow_offload_stat, cpu);
+
+		hit += st->hit;
+		slowpath += st->slowpath;
+		insert += st->insert;
+		delete += st->delete;
+	}
+
+	seq_printf(seq, "entries  hit      slowpath insert   delete\n");
+	seq_printf(seq, "%08x %08x %08x %08x %08x\n", flow_offload_count,
+		   hit, slowpath, insert, delete);
+	return 0;
+}
+
+static int flow_offload_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, flow_offload_stat_show, NULL);
+}
+
+static const struct file_operations flow_offload_stat_fops = {
+	.owner		= THIS_MODULE,
+	.open		= flow_offload_stat_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+#endif /* CONFIG_PROC_FS */
+
+static int __init flowoffload_tg_init(void)
+{
+	int ret;
+
+	get_random_bytes(&flow_offload_hash_rnd, sizeof(flow_offload_hash_rnd));
+
+	flow_offload_stat = alloc_percpu(struct flow_offload_stat);
+	if (flow_offload_stat == NULL)
+		return -ENOMEM;
+
+#ifdef CONFIG_PROC_FS
+	if (!proc_create("flow_offload", S_IRUGO, init_net.proc_net_stat,
+			 &flow_offload_stat_fops)) {
+		ret = -ENOMEM;
+		goto err_stat;
+	}
+#endif
+
+	ret = register_netdevice_notifier(&flow_offload_netdev_notifier);
+	if (ret < 0)
+		goto err_proc;
+
+	ret = nf_register_hook(&flow_offload_ops);
+	if (ret < 0)
+		goto err_notifier;
+
+	ret = xt_register_target(&flowoffload_tg_reg);
+	if (ret < 0)
+		goto err_hook;
+
+	INIT_DELAYED_WORK_DEFERRABLE(&flow_offload_gc_work, flow_offload_gc);
+	schedule_delayed_work(&flow_offload_gc_work, FLOW_OFFLOAD_GC_INTERVAL);
+	return 0;
+
+err_hook:
+	nf_unregister_hook(&flow_offload_ops);
+err_notifier:
+	unregister_netdevice_notifier(&flow_offload_netdev_notifier);
+err_proc:
+#ifdef CONFIG_PROC_FS
+	remove_proc_entry("flow_offload", init_net.proc_net_stat);
+err_stat:
+#endif
+	free_percpu(flow_offload_stat);
+	return ret;
+}
+
+static void __exit flowoffload_tg_exit(void)
+{
+	xt_unregister_target(&flowoffload_tg_reg);
+	nf_unregister_hook(&flow_offload_ops);
+	unregister_netdevice_notifier(&flow_offload_netdev_notifier);
+	cancel_delayed_work_sync(&flow_offload_gc_work);
+	flow_offload_gc_table(NULL, true);
+
+	/* wait for flow_offload_free_rcu() */
+	rcu_barrier();
+#ifdef CONFIG_PROC_FS
+	remove_proc_entry("flow_offload", init_net.proc_net_stat);
+#endif
+	free_percpu(flow_offload_stat);
+}
+
+module_init(flowoffload_tg_init);
+module_exit(flowoffload_tg_exit);
@@ -516,6 +516,8 @@ static int unix_stream_sendmsg(struct kiocb *, struct socket *,
 			       struct msghdr *, size_t);
 static int unix_stream_recvmsg(struct kiocb *, struct socket *,
 			       struct msghdr *, size_t, int);
+static ssize_t unix_stream_sendpage(struct socket *, struct page *, int,
+				    size_t, int);
 static int unix_dgram_sendmsg(struct kiocb *, struct socket *,
 			      struct msghdr *, size_t);
 static int unix_dgram_recvmsg(struct kiocb *, struct socket *,
@@ -545,7 +547,7 @@ static const struct proto_ops unix_stream_ops = {
 	.sendmsg =	unix_stream_sendmsg,
 	.recvmsg =	unix_stream_recvmsg,
 	.mmap =		sock_no_mmap,
-	.sendpage =	sock_no_sendpage,
+	.sendpage =	unix_stream_sendpage,
 };
 
 static const struct proto_ops unix_dgram_ops = {
@@ -1382,6 +1384,15 @@ static int unix_attach_fds(struct scm_cookie *scm, struct sk_buff *skb)
 	return max_level;
 }
 
+/*
+ * Stream skbs are read in place, the part already read is skipped, as
+ * the page fragments added by unix_stream_sendpage() can't be pulled.
+ */
+static inline unsigned int unix_skb_len(const struct sk_buff *skb)
+{
+	return skb->len - UNIXCB(skb).consumed;
+}
+
 static int unix_scm_to_skb(struct scm_cookie *scm, struct sk_buff *skb, bool send_fds)
 {
 	int err = 0;
@@ -1682,6 +1693,116 @@ out_err:
 	return sent ? : err;
 }
 
+/*
+ * Queue page references instead of copying, for splice() from a pipe,
+ * e.g. one filled by vmsplice().  The pages are added to the last skb
+ * of the peer's queue while it has room and comes from the same
+ * writer, so a large splice does not make one skb per page.  The
+ * peer's readlock keeps the reader from consuming that skb meanwhile.
+ */
+static ssize_t unix_stream_sendpage(struct socket *sock, struct page *page,
+				    int offset, size_t size, int flags)
+{
+	struct sock *sk = sock->sk;
+	struct sock *other;
+	struct sk_buff *skb, *newskb = NULL;
+	struct scm_cookie scm;
+	struct msghdr msg = { .msg_controllen = 0 };
+	int i, err;
+
+	if (flags & MSG_OOB)
+		return -EOPNOTSUPP;
+
+	other = unix_peer(sk);
+	if (!other || sk->sk_state != TCP_ESTABLISHED)
+		return -ENOTCONN;
+
+	wait_for_unix_gc();
+	err = scm_send(sock, &msg, &scm);
+	if (err < 0)
+		return err;
+
+again:
+	err = mutex_lock_interruptible(&unix_sk(other)->readlock);
+	if (err) {
+		err = sock_intr_errno(sock_sndtimeo(sk, flags & MSG_DONTWAIT));
+		goto out_free;
+	}
+
+	if (sk->sk_shutdown & SEND_SHUTDOWN)
+		goto pipe_err;
+
+	unix_state_lock(other);
+
+	if (sock_flag(other, SOCK_DEAD) ||
+	    (other->sk_shutdown & RCV_SHUTDOWN)) {
+		unix_state_unlock(other);
+		goto pipe_err;
+	}
+
+	skb = newskb;
+	if (!skb) {
+		skb = skb_peek_tail(&other->sk_receive_queue);
+		if (!skb || skb->sk != sk || UNIXCB(skb).fp ||
+		    UNIXCB(skb).pid != scm.pid ||
+		    UNIXCB(skb).cred != scm.cred)
+			skb = NULL;
+	}
+
+	if (skb) {
+		i = skb_shinfo(skb)->nr_frags;
+		if (skb_can_coalesce(skb, i, page, offset)) {
+			skb_shinfo(skb)->frags[i - 1].size += size;
+		} else if (i < MAX_SKB_FRAGS) {
+			get_page(page);
+			skb_fill_page_desc(skb, i, page, offset, size);
+		} else {
+			skb = NULL;
+		}
+	}
+
+	if (!skb) {
+		/* no skb to add to: get one, sleeping for sndbuf space */
+		unix_state_unlock(other);
+		mutex_unlock(&unix_sk(other)->readlock);
+
+		newskb = sock_alloc_send_pskb(sk, 0, 0,
+					      flags & MSG_DONTWAIT, &err);
+		if (!newskb)
+			goto out_err;
+		err = unix_scm_to_skb(&scm, newskb, false);
+		if (err < 0)
+			goto out_free;
+		goto again;
+	}
+
+	skb->len += size;
+	skb->data_len += size;
+	skb->truesize += size;
+	atomic_add(size, &sk->sk_wmem_alloc);
+
+	if (newskb)
+		skb_queue_tail(&other->sk_receive_queue, newskb);
+
+	unix_state_unlock(other);
+	mutex_unlock(&unix_sk(other)->readlock);
+
+	other->sk_data_ready(other, size);
+	scm_destroy(&scm);
+	return size;
+
+pipe_err:
+	mutex_unlock(&unix_sk(other)->readlock);
+	if (!(flags & MSG_NOSIGNAL))
+		send_sig(SIGPIPE, current, 0);
+	err = -EPIPE;
+out_free:
+	kfree_skb(newskb);
+out_err:
+	scm_destroy(&scm);
+	return err;
+}
+
 static int unix_seqpacket_sendmsg(struct kiocb *kiocb, struct socket *sock,
 				  struct msghdr *msg, size_t len)
 {
@@ -1953,8 +2074,9 @@ static int unix_stream_recvmsg(struct kiocb *iocb, struct socket *sock,
 			sunaddr = NULL;
 		}
 
-		chunk = min_t(unsigned int, skb->len, size);
-		if (memcpy_toiovec(msg->msg_iov, skb->data, chunk)) {
+		chunk = min_t(unsigned int, unix_skb_len(skb), size);
+		if (skb_copy_datagram_iovec(skb, UNIXCB(skb).consumed,
+					    msg->msg_iov, chunk)) {
 			skb_queue_head(&sk->sk_receive_queue, skb);
 			if (copied == 0)
 				copied = -EFAULT;
@@ -1965,13 +2087,13 @@ static int unix_stream_recvmsg(struct kiocb *iocb, struct socket *sock,
 
 		/* Mark read part of skb as used */
 		if (!(flags & MSG_PEEK)) {
-			skb_pull(skb, chunk);
+			UNIXCB(skb).consumed += chunk;
 
 			if (UNIXCB(skb).fp)
 				unix_detach_fds(siocb->scm, skb);
 
 			/* put the skb back if we didn't use it up.. */
-			if (skb->len) {
+			if (unix_skb_len(skb)) {
 				skb_queue_head(&sk->sk_receive_queue, skb);
 				break;
 			}
@@ -2064,7 +2186,7 @@ static int unix_ioctl(struct socket *sock, unsigned int cmd, unsigned long arg)
 			if (sk->sk_type == SOCK_STREAM ||
 			    sk->sk_type == SOCK_SEQPACKET) {
 				skb_queue_walk(&sk->sk_receive_queue, skb)
-					amount += skb->len;
+					amount += unix_skb_len(skb);
 			} else {
 				skb = skb_peek(&sk->sk_receive_queue);
 				if (skb)
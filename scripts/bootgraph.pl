@@ -94,6 +94,26 @@ while (<>) {
 		}
 	}
 
+	if ($line =~ /([0-9\.]+)\] probing  (\S+) with (\S+) @ ([0-9]+)/) {
+		my $func = $3 . ":" . $2;
+		if ($done == 0) {
+			$start{$func} = $1;
+			$type{$func} = 0;
+			if ($1 < $firsttime) {
+				$firsttime = $1;
+			}
+		}
+		$pids{$func} = $4;
+		$count = $count + 1;
+	}
+
+	if ($line =~ /([0-9\.]+)\] probe of (\S+) with (\S+) returned/) {
+		if ($done == 0) {
+			$end{$3 . ":" . $2} = $1;
+			$maxtime = $1;
+		}
+	}
+
 	if ($line =~ /([0-9\.]+)\] async_continuing @ ([0-9]+)/) {
 		my $pid = $2;
 		my $func =  "wait_" . $pid . "_" . $pidctr{$pid};
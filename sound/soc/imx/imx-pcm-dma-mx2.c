@@ -23,6 +23,7 @@
 #include <linux/dmaengine.h>
 #include <linux/delay.h>
 #include <linux/mxc_asrc.h>
+#include <linux/pm_qos_params.h>
 
 #include <sound/core.h>
 #include <sound/initval.h>
@@ -248,6 +249,7 @@ static int snd_imx_pcm_hw_params(struct snd_pcm_substream *substream,
 	unsigned long dma_addr;
 	struct dma_chan *chan;
 	struct imx_pcm_dma_params *dma_params;
+	s32 bandwidth;
 	int ret;
 
 	dma_params = snd_soc_dai_get_dma_data(rtd->cpu_dai, substream);
@@ -282,6 +284,16 @@ static int snd_imx_pcm_hw_params(struct snd_pcm_substream *substream,
 	iprtd->period_time = HZ / (params_rate(params) /
 					params_period_size(params));
 
+	/* the core already asks for a period worth of CPU DMA latency */
+	bandwidth = DIV_ROUND_UP(params_rate(params) * params_channels(params) *
+			snd_pcm_format_physical_width(params_format(params)),
+			8 * 1000);
+	if (pm_qos_request_active(&iprtd->pm_qos_bw))
+		pm_qos_update_request(&iprtd->pm_qos_bw, bandwidth);
+	else
+		pm_qos_add_request(&iprtd->pm_qos_bw, PM_QOS_BUS_BANDWIDTH,
+				   bandwidth);
+
 	snd_pcm_set_runtime_buffer(substream, &substream->dma_buffer);
 
 	dma_addr = runtime->dma_addr;
@@ -345,6 +357,9 @@ static int snd_imx_pcm_hw_free(struct snd_pcm_substream *substream)
 		}
 	}
 
+	if (pm_qos_request_active(&iprtd->pm_qos_bw))
+		pm_qos_remove_request(&iprtd->pm_qos_bw);
+
 	return 0;
 }
 
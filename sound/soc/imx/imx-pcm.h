@@ -61,6 +61,7 @@ struct imx_pcm_runtime_data {
 	struct imx_dma_data dma_data;
 	int asrc_enable;
 	struct asrc_p2p_ops *asrc_pcm_p2p_ops_ko;
+	struct pm_qos_request_list pm_qos_bw;
 
 #if defined(CONFIG_MXC_ASRC) || defined(CONFIG_IMX_HAVE_PLATFORM_IMX_ASRC)
 	enum asrc_pair_index asrc_index;
@@ -702,6 +702,46 @@ parse_raw_event(const char **strp, struct perf_event_attr *attr)
 	return EVT_FAILED;
 }
 
+/*
+ * PMUs registered at run time, such as the counters of a cache or memory
+ * controller, have a dynamic type found in sysfs: <pmu>/config=<N>/
+ */
+static enum event_result
+parse_pmu_event(const char **strp, struct perf_event_attr *attr)
+{
+	const char *str = *strp;
+	char path[MAXPATHLEN];
+	char *endp;
+	size_t len;
+	u64 config;
+	int type;
+	FILE *file;
+
+	len = strcspn(str, "/,:");
+	if (!len || str[len] != '/' || strncmp(str + len + 1, "config=", 7))
+		return EVT_FAILED;
+
+	config = strtoull(str + len + 8, &endp, 0);
+	if (endp == str + len + 8 || *endp != '/')
+		return EVT_FAILED;
+
+	snprintf(path, MAXPATHLEN, "/sys/bus/event_source/devices/%.*s/type",
+		 (int)len, str);
+	file = fopen(path, "r");
+	if (!file)
+		return EVT_FAILED;
+	if (fscanf(file, "%d", &type) != 1) {
+		fclose(file);
+		return EVT_FAILED;
+	}
+	fclose(file);
+
+	attr->type = type;
+	attr->config = config;
+	*strp = endp + 1;
+	return EVT_HANDLED;
+}
+
 static enum event_result
 parse_numeric_event(const char **strp, struct perf_event_attr *attr)
 {
@@ -787,6 +827,10 @@ parse_event_symbols(const struct option *opt, const char **str,
 	if (ret != EVT_FAILED)
 		goto modifier;
 
+	ret = parse_pmu_event(str, attr);
+	if (ret != EVT_FAILED)
+		goto modifier;
+
 	ret = parse_raw_event(str, attr);
 	if (ret != EVT_FAILED)
 		goto modifier;
@@ -1082,6 +1126,11 @@ void print_events(const char *event_glob)
 	       event_type_descriptors[PERF_TYPE_RAW]);
 	printf("\n");
 
+	printf("  %-50s [%s]\n",
+		"<pmu>/config=<N>/ (see 'perf list --help')",
+		"Dynamic PMU event");
+	printf("\n");
+
 	printf("  %-50s [%s]\n",
 			"mem:<addr>[:access]",
 			event_type_descriptors[PERF_TYPE_BREAKPOINT]);